@@ -0,0 +1,386 @@
+#include "include/cat_behavior.h"
+#include <cmath>
+#include <cstdlib>
+
+CatBehavior::CatBehavior(const FrameDesc* frameTable, const WindowIndex* windowIndex,
+                         double startX, double startY, int mouseX, int mouseY, Uint32 now)
+    : frameTable(frameTable), windowIndex(windowIndex), x(startX), y(startY),
+      state(IDLE), lastState(IDLE), lastAnimationType(IDLE),
+      direction(SOUTH), idleMs(0), tiredMs(0),
+      inIdleBuffer(true), inChaseMode(false),
+      lastMouseDistance(0.0),
+      lastMouseX(mouseX), lastMouseY(mouseY), lastMouseMoveTime(now),
+      lastAnimTime(0), currentAnimFrame(0),
+      stateStartTime(0), idleBufferStartTime(0), idleFrozen(false),
+      perchWindow(None), perchRect({0, 0, 0, 0}),
+      predictCursor(false), lastUpdateTime(now) {
+    cursor.reset(mouseX, mouseY, now);
+}
+
+Direction CatBehavior::calculateDirection(double dx, double dy) {
+    double dist = sqrt(dx * dx + dy * dy);
+    if (dist < 0.1) return direction;
+
+    double nx = dx / dist;
+    double ny = dy / dist;
+
+    // Determine direction based on normalized vector
+    if (ny < -0.5) {
+        if (nx > 0.5) return NORTHEAST;
+        if (nx < -0.5) return NORTHWEST;
+        return NORTH;
+    } else if (ny > 0.5) {
+        if (nx > 0.5) return SOUTHEAST;
+        if (nx < -0.5) return SOUTHWEST;
+        return SOUTH;
+    } else {
+        if (nx > 0) return EAST;
+        return WEST;
+    }
+}
+
+void CatBehavior::steerAroundWindows(double* nx, double* ny, double goalX, double goalY) {
+    // Direct heading first, then rotate away from it in 45 degree steps (cos, sin)
+    static const double rotations[][2] = {
+        {1.0, 0.0},
+        {0.70710678, 0.70710678}, {0.70710678, -0.70710678},
+        {0.0, 1.0}, {0.0, -1.0},
+        {-0.70710678, 0.70710678}, {-0.70710678, -0.70710678}
+    };
+
+    for (const auto& rot : rotations) {
+        double hx = *nx * rot[0] - *ny * rot[1];
+        double hy = *nx * rot[1] + *ny * rot[0];
+
+        if (!windowIndex || !windowIndex->segmentIntersects(x, y,
+                                           x + hx * OBSTACLE_LOOKAHEAD, y + hy * OBSTACLE_LOOKAHEAD,
+                                           goalX, goalY)) {
+            *nx = hx;
+            *ny = hy;
+            return;
+        }
+    }
+    // Boxed in on all sides: keep the direct heading
+}
+
+void CatBehavior::tryPerch(double mouseX, double mouseY) {
+    double perchX, perchY;
+    Window w;
+    double feetY = y + spriteSize() / 2.0;
+
+    if (!windowIndex || !windowIndex->nearestPerch(x, feetY, PERCH_SNAP_DISTANCE, &perchX, &perchY, &w)) {
+        return;
+    }
+
+    // Only hop if the cat still rests within the inner radius afterwards
+    double newY = perchY - spriteSize() / 2.0;
+    double dx = mouseX - perchX;
+    double dy = mouseY - newY;
+    if (sqrt(dx * dx + dy * dy) > ALERT_DEADZONE_INNER) {
+        return;
+    }
+
+    x = perchX;
+    y = newY;
+    perchWindow = w;
+    windowIndex->getWindow(w, &perchRect);
+}
+
+void CatBehavior::followPerch() {
+    if (perchWindow == None || !windowIndex) {
+        return;
+    }
+
+    WindowRect rect;
+    if (!windowIndex->getWindow(perchWindow, &rect)) {
+        perchWindow = None;  // Window closed or unmapped, cat stays where it is
+        return;
+    }
+
+    if (rect.x == perchRect.x && rect.y == perchRect.y) {
+        return;
+    }
+
+    // Ride along with the window
+    x += rect.x - perchRect.x;
+    y += rect.y - perchRect.y;
+    perchRect = rect;
+}
+
+void CatBehavior::update(int mouse_x, int mouse_y, Uint32 currentTime) {
+    // The last tick's length drives movement and is the best guess for the next one
+    Uint32 tickMs = currentTime - lastUpdateTime;
+    if (tickMs > MAX_TICK_MS) {
+        tickMs = MAX_TICK_MS;
+    }
+    lastUpdateTime = currentTime;
+
+    cursor.addSample(mouse_x, mouse_y, currentTime);
+
+    // Calculate distance from cat to mouse
+    double dx = mouse_x - x;
+    double dy = mouse_y - y;
+    double distance = sqrt(dx * dx + dy * dy);
+
+    // Track mouse movement for sleep detection
+    if (mouse_x != lastMouseX || mouse_y != lastMouseY) {
+        // Mouse has moved
+        lastMouseX = mouse_x;
+        lastMouseY = mouse_y;
+        lastMouseMoveTime = currentTime;
+
+        // Wake up if sleeping and mouse moves
+        if (state == SLEEPING) {
+            state = WAKING_UP;
+            tiredMs = 0;
+        } else if (state == FALLING_ASLEEP) {
+            // Cancel falling asleep if mouse moves
+            state = IDLE;
+            inIdleBuffer = true;
+            idleBufferStartTime = currentTime;
+        }
+    }
+
+    // Track state changes and initialize timing
+    if (state != lastState) {
+        stateStartTime = currentTime;
+        lastState = state;
+    }
+
+    // Track mouse distance for future use
+    lastMouseDistance = distance;
+
+    // State machine logic with chase mode and deadzone
+    if (inChaseMode) {
+        // CHASE MODE: Deadzone disabled, chase until inner radius (50px)
+        if (distance > ALERT_DEADZONE_INNER) {
+            // Still chasing
+            state = RUNNING;
+            idleMs = 0;
+            tiredMs = 0;
+            perchWindow = None;
+
+            // Head for the last sample, or where the cursor will be at the next present
+            double targetX = mouse_x, targetY = mouse_y;
+            if (predictCursor) {
+                cursor.predict(currentTime + tickMs, &targetX, &targetY);
+            }
+
+            double tx = targetX - x;
+            double ty = targetY - y;
+            double targetDistance = sqrt(tx * tx + ty * ty);
+
+            double nx = dx / distance;
+            double ny = dy / distance;
+            if (targetDistance > 0.1) {
+                nx = tx / targetDistance;
+                ny = ty / targetDistance;
+            }
+
+            // Walk around windows in the way
+            steerAroundWindows(&nx, &ny, targetX, targetY);
+
+            direction = calculateDirection(nx, ny);
+
+            // Integrate over the tick length so chase speed doesn't depend on the tick rate
+            double step = CHASE_SPEED * tickMs / 1000.0;
+            x += nx * step;
+            y += ny * step;
+        } else {
+            // Reached inner radius - stop and re-enable deadzone, show IDLE
+            inChaseMode = false;
+            state = IDLE;
+            inIdleBuffer = true;
+            idleBufferStartTime = currentTime;  // Start idle buffer timer
+            idleMs = IDLE_ANIMATION_THRESHOLD_MS;
+            tiredMs = 0;
+
+            // Sit on a nearby title bar if there is one
+            tryPerch(mouse_x, mouse_y);
+        }
+    } else {
+        followPerch();
+
+        // IDLE MODE: Deadzone enabled
+        if (distance > ALERT_DEADZONE_OUTER) {
+            // Mouse far away - start chasing (disable deadzone)
+            inChaseMode = true;
+            state = RUNNING;
+            idleMs = 0;
+            tiredMs = 0;
+        } else if (distance > ALERT_DEADZONE_INNER) {
+            // In deadzone - show alert (no movement)
+            state = ALERT;
+            idleMs = 0;
+            tiredMs = 0;
+            inIdleBuffer = false;
+        } else {
+            // Inside cat zone - random animations
+            if (idleMs < IDLE_ANIMATION_THRESHOLD_MS) {
+                idleMs += tickMs;
+            }
+
+            if (state == RUNNING || state == ALERT) {
+                // Just arrived at cat zone - show IDLE frame, then wait before animation
+                state = IDLE;
+                inIdleBuffer = true;
+                idleBufferStartTime = currentTime;  // Start idle buffer timer
+                idleMs = IDLE_ANIMATION_THRESHOLD_MS;  // Skip initial wait
+                tiredMs = 0;
+            } else if (idleMs >= IDLE_ANIMATION_THRESHOLD_MS) {
+            // Been idle for a while, check for sleep or animation changes
+
+            // Check if mouse has been idle long enough to trigger sleep
+            Uint32 mouseIdleTime = currentTime - lastMouseMoveTime;
+            if (mouseIdleTime >= MOUSE_IDLE_SLEEP_TIME_MS && state != SLEEPING && state != FALLING_ASLEEP && state != WAKING_UP) {
+                // Mouse idle for too long, go to sleep
+                state = FALLING_ASLEEP;
+                lastAnimationType = SLEEPING;
+                tiredMs = 0;
+            } else if (state == FALLING_ASLEEP) {
+                tiredMs += tickMs;
+                if (tiredMs >= TIRED_DELAY_MS) {
+                    state = SLEEPING;
+                    tiredMs = 0;
+                }
+            } else if (state == SLEEPING) {
+                // Sleep continues until mouse moves (handled above in mouse movement detection)
+                // Just keep sleeping...
+            } else if (state == WAKING_UP) {
+                tiredMs += tickMs;
+                if (tiredMs >= TIRED_DELAY_MS) {
+                    state = IDLE;
+                    inIdleBuffer = true;
+                    idleBufferStartTime = currentTime;
+                    lastAnimationType = SLEEPING;  // Mark that we just woke from sleep
+                    tiredMs = 0;
+                }
+            } else if (state == IDLE && inIdleBuffer) {
+                // In idle buffer, wait before picking next animation
+                Uint32 timeInBuffer = currentTime - idleBufferStartTime;
+                if (timeInBuffer >= IDLE_BUFFER_TIME_MS) {
+                    // Build list of available animations (excluding last played)
+                    // Note: Sleep is NOT in random selection - triggered by mouse idle instead
+                    CatState availableAnims[4];
+                    int availableCount = 0;
+
+                    if (lastAnimationType != IDLE) availableAnims[availableCount++] = IDLE;
+                    if (lastAnimationType != SCRATCHING) availableAnims[availableCount++] = SCRATCHING;
+                    if (lastAnimationType != ITCHING) availableAnims[availableCount++] = ITCHING;
+                    if (lastAnimationType != PAWUP) availableAnims[availableCount++] = PAWUP;
+
+                    // Pick random animation from available
+                    CatState nextAnim = availableAnims[rand() % availableCount];
+                    state = nextAnim;
+                    lastAnimationType = nextAnim;
+
+                    if (nextAnim == SCRATCHING) {
+                        // Pick random direction for scratching
+                        int randomDir = rand() % 4;
+                        direction = (randomDir == 0) ? NORTH : (randomDir == 1) ? EAST : (randomDir == 2) ? SOUTH : WEST;
+                    }
+                    inIdleBuffer = false;
+                }
+            } else {
+                // Playing an animation, check if should return to idle buffer
+                // Exception: SLEEPING state has its own wake-up logic, don't apply min/max time
+                if (state != SLEEPING) {
+                    Uint32 timeInState = currentTime - stateStartTime;
+                    bool shouldSwitch = false;
+
+                    if (timeInState >= ANIM_PLAY_TIME_MAX_MS) {
+                        shouldSwitch = true;  // Force switch after max time
+                    } else if (timeInState >= ANIM_PLAY_TIME_MIN_MS) {
+                        // After min time, random chance to switch that scales with the tick length
+                        double switchChance = 1.0 - pow(0.5, tickMs / ANIM_SWITCH_HALF_LIFE_MS);
+                        if (rand() < switchChance * RAND_MAX) {
+                            shouldSwitch = true;
+                        }
+                    }
+
+                    if (shouldSwitch) {
+                        // Return to idle buffer
+                        state = IDLE;
+                        inIdleBuffer = true;
+                        idleBufferStartTime = currentTime;
+                    }
+                }
+            }
+        }
+        }
+    }
+
+    // Animation timing comes straight from the frame table
+    const FrameDesc& anim = frameTable[frameIndex(state, direction, 0)];
+
+    // Update animation frame based on time
+    if (lastAnimTime == 0) {
+        lastAnimTime = currentTime;
+    }
+
+    // Running, alert and the sleep transitions keep animating when frozen
+    bool frozen = idleFrozen && (state == IDLE || state == SLEEPING || state == SCRATCHING ||
+                                 state == ITCHING || state == PAWUP);
+
+    if (!frozen && anim.durationMs > 0 && currentTime - lastAnimTime >= (Uint32)anim.durationMs) {
+        currentAnimFrame = (currentAnimFrame + 1) % anim.frameCount;
+        lastAnimTime = currentTime;
+    }
+}
+
+void CatBehavior::catchUp(int mouse_x, int mouse_y, Uint32 elapsedMs) {
+    double dx = mouse_x - x;
+    double dy = mouse_y - y;
+    double distance = sqrt(dx * dx + dy * dy);
+    if (distance <= ALERT_DEADZONE_INNER) {
+        return;
+    }
+
+    // Cover the ground the chase would have covered while hidden
+    double travel = CHASE_SPEED * elapsedMs / 1000.0;
+    double nx = dx / distance;
+    double ny = dy / distance;
+
+    if (travel >= distance - ALERT_DEADZONE_INNER) {
+        // Would have arrived: rest at the inner radius
+        x = mouse_x - nx * ALERT_DEADZONE_INNER;
+        y = mouse_y - ny * ALERT_DEADZONE_INNER;
+        inChaseMode = false;
+        state = IDLE;
+        inIdleBuffer = true;
+        idleMs = IDLE_ANIMATION_THRESHOLD_MS;
+        tiredMs = 0;
+    } else {
+        x += nx * travel;
+        y += ny * travel;
+        inChaseMode = true;
+        state = RUNNING;
+        direction = calculateDirection(dx, dy);
+    }
+
+    perchWindow = None;
+}
+
+void CatBehavior::resume(int mouseX, int mouseY, Uint32 currentTime, bool fellAsleep) {
+    // Time spent suspended doesn't count towards any animation or idle timer
+    lastAnimTime = currentTime;
+    stateStartTime = currentTime;
+    idleBufferStartTime = currentTime;
+    lastMouseMoveTime = currentTime;
+
+    // Take the current pointer as the baseline so unlocking alone doesn't look like movement
+    lastMouseX = mouseX;
+    lastMouseY = mouseY;
+    cursor.reset(mouseX, mouseY, currentTime);
+    lastUpdateTime = currentTime;
+
+    // The user was away: come back asleep, the next mouse move wakes the cat
+    if (fellAsleep && !inChaseMode) {
+        state = SLEEPING;
+        lastState = SLEEPING;
+        lastAnimationType = SLEEPING;
+        idleMs = IDLE_ANIMATION_THRESHOLD_MS;
+        tiredMs = 0;
+        inIdleBuffer = false;
+    }
+}
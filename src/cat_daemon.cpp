@@ -0,0 +1,659 @@
+#include "include/cat_daemon.h"
+#include <X11/Xutil.h>
+#include <X11/extensions/shape.h>
+#include <X11/extensions/XInput2.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+const std::vector<DaemonDisplay*>* errorDisplays = nullptr;  // The daemon's displays, for the error handler
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+// Windows vanish between an event and the window index's query; that error
+// is expected on every display. Any other error detaches only the display it
+// came from: Xlib's default handler would exit() and take every display down.
+int handleX11Error(Display* display, XErrorEvent* error) {
+    if (error->error_code == BadWindow) {
+        return 0;
+    }
+
+    char text[256];
+    XGetErrorText(display, error->error_code, text, sizeof(text));
+    for (size_t i = 0; errorDisplays && i < errorDisplays->size(); i++) {
+        DaemonDisplay* d = (*errorDisplays)[i];
+        if (d->display == display) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "X error on display %s: %s (request %d.%d)",
+                         d->name.c_str(), text, error->request_code, error->minor_code);
+            d->lost = true;
+            return 0;
+        }
+    }
+
+    // A display still being attached: its setup goes on, the error is only reported
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "X error on %s: %s (request %d.%d)",
+                 DisplayString(display), text, error->request_code, error->minor_code);
+    return 0;
+}
+
+#ifdef HAVE_XIOERROR_EXIT_HANDLER
+// Replaces Xlib's exit() when a server goes away, so the other displays keep running
+void markDisplayLost(Display*, void* data) {
+    ((DaemonDisplay*)data)->lost = true;
+}
+#endif
+
+// Raw motion on the root window marks the pointer for re-query; -1 without XI 2.1
+int selectRawMotion(Display* dpy) {
+    int opcode, event, error;
+    int major = 2, minor = 1;
+    if (!XQueryExtension(dpy, "XInputExtension", &opcode, &event, &error) ||
+        XIQueryVersion(dpy, &major, &minor) != Success || (major == 2 && minor < 1)) {
+        return -1;
+    }
+
+    unsigned char bits[XIMaskLen(XI_RawMotion)];
+    memset(bits, 0, sizeof(bits));
+    XISetMask(bits, XI_RawMotion);
+
+    XIEventMask mask;
+    mask.deviceid = XIAllDevices;
+    mask.mask_len = sizeof(bits);
+    mask.mask = bits;
+    XISelectEvents(dpy, DefaultRootWindow(dpy), &mask, 1);
+    return opcode;
+}
+
+bool controlSocketPath(std::string* path) {
+    const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if (!runtimeDir || !*runtimeDir) {
+        return false;
+    }
+    *path = std::string(runtimeDir) + "/" + DAEMON_SOCKET_NAME;
+    return path->size() < sizeof(((sockaddr_un*)0)->sun_path);
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+// 8-bit channel value placed under a TrueColor visual's mask
+unsigned long channelBits(Uint8 value, unsigned long mask) {
+    if (!mask) {
+        return 0;
+    }
+    int shift = __builtin_ctzl(mask);
+    int bits = __builtin_popcountl(mask);
+    unsigned long scaled = bits >= 8 ? (unsigned long)value << (bits - 8) : value >> (8 - bits);
+    return (scaled << shift) & mask;
+}
+
+}  // namespace
+
+DaemonDisplay::DaemonDisplay(const std::string& name, Display* display, const FrameDesc* frameTable,
+                             double startX, double startY, int mouseX, int mouseY, Uint32 now)
+    : name(name), display(display), lost(false), window(0), sheet(0), gc(0), xfixes(false),
+      suspended(false), xiOpcode(-1), pointerMoved(false),
+      mouseX(mouseX), mouseY(mouseY), windowX(0), windowY(0), shownCell(-1),
+      behavior(frameTable, &windowIndex, startX, startY, mouseX, mouseY, now) {
+}
+
+CatDaemon::CatDaemon() : spriteSheetSurface(nullptr), mappedSheet(nullptr), spriteSize(0),
+                         sheetColumns(0), sheetRows(0), controlFd(-1) {
+}
+
+CatDaemon::~CatDaemon() {
+    // Out of the list first: the error handler walks it while a display closes
+    while (!displays.empty()) {
+        DaemonDisplay* d = displays.back();
+        displays.pop_back();
+        destroyDisplay(d);
+    }
+    errorDisplays = nullptr;
+
+    for (ControlClient& client : clients) {
+        close(client.fd);
+    }
+    if (controlFd >= 0) {
+        close(controlFd);
+        unlink(controlPath.c_str());
+    }
+
+    if (spriteSheetSurface) {
+        SDL_FreeSurface(spriteSheetSurface);
+    }
+    delete mappedSheet;
+}
+
+bool CatDaemon::loadSheet(const char* path) {
+    spriteSheetSurface = sheetCache.load(path, &mappedSheet);
+    if (!spriteSheetSurface) {
+        return false;
+    }
+
+    spriteSize = detectFrameSize(spriteSheetSurface->w, spriteSheetSurface->h);
+    sheetColumns = spriteSheetSurface->w / spriteSize;
+    sheetRows = spriteSheetSurface->h / spriteSize;
+    fillFrameTable(frameTable, spriteSize);
+
+    // Every display gets its regions from these, packed once
+    const SpriteKernels* kernels = spriteKernelsFor(spriteSize);
+    cellRects.assign(sheetColumns * sheetRows, std::vector<XRectangle>());
+    for (int row = 0; row < sheetRows; row++) {
+        for (int column = 0; column < sheetColumns; column++) {
+            std::vector<XRectangle>* rects = &cellRects[row * sheetColumns + column];
+            if (mappedSheet && mappedSheet->cellShape(column, row, rects)) {
+                continue;
+            }
+            const Uint8* cell = (const Uint8*)spriteSheetSurface->pixels +
+                                row * spriteSize * spriteSheetSurface->pitch + column * spriteSize * 4;
+            kernels->packShape(cell, spriteSheetSurface->pitch, rects);
+        }
+    }
+    return true;
+}
+
+bool CatDaemon::openControlSocket() {
+    if (!controlSocketPath(&controlPath)) {
+        return false;
+    }
+    sockaddr_un addr = socketAddress(controlPath);
+
+    // A socket nobody answers on is left over from a daemon that died
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && connect(probe, (sockaddr*)&addr, sizeof(addr)) == 0) {
+        close(probe);
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "A daemon is already listening on %s", controlPath.c_str());
+        controlPath.clear();
+        return false;
+    }
+    if (probe >= 0) {
+        close(probe);
+    }
+    unlink(controlPath.c_str());
+
+    controlFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (controlFd < 0 ||
+        bind(controlFd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        chmod(controlPath.c_str(), 0600) != 0 ||
+        listen(controlFd, 8) != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to listen on %s: %s",
+                     controlPath.c_str(), strerror(errno));
+        if (controlFd >= 0) {
+            close(controlFd);
+            controlFd = -1;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool CatDaemon::init(const char* sheetPath) {
+    errorDisplays = &displays;
+    XSetErrorHandler(handleX11Error);
+#ifndef HAVE_XIOERROR_EXIT_HANDLER
+    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Built against libX11 older than 1.7: losing any display stops the daemon");
+#endif
+
+    // Decoded sheets shared with other daemons and sessions
+    sheetCache.init();
+    if (!loadSheet(sheetPath)) {
+        return false;
+    }
+
+    if (openControlSocket()) {
+        SDL_Log("Listening for attach/detach on %s", controlPath.c_str());
+    } else {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "No control socket, displays are fixed");
+    }
+    return true;
+}
+
+bool CatDaemon::uploadSheet(DaemonDisplay* d) {
+    Display* dpy = d->display;
+    int screen = DefaultScreen(dpy);
+    Visual* visual = DefaultVisual(dpy, screen);
+    int depth = DefaultDepth(dpy, screen);
+
+    if (visual->c_class != TrueColor) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Display %s has no TrueColor visual", d->name.c_str());
+        return false;
+    }
+
+    // Convert once to the server's pixel layout; frames are then copied server-side
+    int w = spriteSheetSurface->w;
+    int h = spriteSheetSurface->h;
+    XImage* image = XCreateImage(dpy, visual, depth, ZPixmap, 0, nullptr, w, h, 32, 0);
+    if (!image) {
+        return false;
+    }
+    image->data = (char*)malloc((size_t)image->bytes_per_line * h);
+    if (!image->data) {
+        XDestroyImage(image);
+        return false;
+    }
+
+    for (int y = 0; y < h; y++) {
+        const Uint8* row = (const Uint8*)spriteSheetSurface->pixels + y * spriteSheetSurface->pitch;
+        for (int x = 0; x < w; x++) {
+            const Uint8* p = row + x * 4;
+            XPutPixel(image, x, y, channelBits(p[0], visual->red_mask) |
+                                   channelBits(p[1], visual->green_mask) |
+                                   channelBits(p[2], visual->blue_mask));
+        }
+    }
+
+    d->sheet = XCreatePixmap(dpy, RootWindow(dpy, screen), w, h, depth);
+    GC pixmapGc = XCreateGC(dpy, d->sheet, 0, nullptr);
+    XPutImage(dpy, d->sheet, pixmapGc, image, 0, 0, 0, 0, w, h);
+    XFreeGC(dpy, pixmapGc);
+    XDestroyImage(image);
+    return true;
+}
+
+bool CatDaemon::attach(const std::string& name, std::string* reply) {
+    if (findDisplay(name)) {
+        *reply = "error: " + name + " is already attached";
+        return false;
+    }
+
+    // XOpenDisplay blocks until the server answers or the connection fails, and
+    // every display waits with it: an unresponsive server stalls all cats
+    Display* dpy = XOpenDisplay(name.c_str());
+    if (!dpy) {
+        *reply = "error: cannot open display " + name;
+        return false;
+    }
+
+    int screen = DefaultScreen(dpy);
+    Window root = RootWindow(dpy, screen);
+
+    // Start mid-screen, as the desktop cat does
+    Window rootReturn, childReturn;
+    int mouseX = 0, mouseY = 0, winX, winY;
+    unsigned int mask;
+    XQueryPointer(dpy, root, &rootReturn, &childReturn, &mouseX, &mouseY, &winX, &winY, &mask);
+    double startX = DisplayWidth(dpy, screen) / 2.0;
+    double startY = DisplayHeight(dpy, screen) / 2.0;
+
+    DaemonDisplay* d = new DaemonDisplay(name, dpy, frameTable, startX, startY, mouseX, mouseY, SDL_GetTicks());
+#ifdef HAVE_XIOERROR_EXIT_HANDLER
+    XSetIOErrorExitHandler(dpy, markDisplayLost, d);
+#endif
+
+    if (!uploadSheet(d)) {
+        *reply = "error: cannot upload sprites to " + name;
+        destroyDisplay(d);
+        return false;
+    }
+
+    // Override-redirect: no frame, no taskbar entry, no window manager placement
+    XSetWindowAttributes attrs;
+    attrs.override_redirect = True;
+    attrs.background_pixmap = None;
+    attrs.event_mask = ExposureMask;
+    d->windowX = (int)(startX - spriteSize/2);
+    d->windowY = (int)(startY - spriteSize/2);
+    d->window = XCreateWindow(dpy, root, d->windowX, d->windowY, spriteSize, spriteSize, 0,
+                              CopyFromParent, InputOutput, CopyFromParent,
+                              CWOverrideRedirect | CWBackPixmap | CWEventMask, &attrs);
+    d->gc = XCreateGC(dpy, d->window, 0, nullptr);
+
+    // Per-connection copies of the shared shapes
+    int eventBase, errorBase;
+    d->xfixes = XFixesQueryExtension(dpy, &eventBase, &errorBase);
+    if (d->xfixes) {
+        for (std::vector<XRectangle>& rects : cellRects) {
+            d->cellRegions.push_back(XFixesCreateRegion(dpy, rects.data(), (int)rects.size()));
+        }
+    }
+
+    // Perching and suspension, on the same connection: nobody else reads its events
+    d->windowIndex.init(dpy);
+    d->windowIndex.ignoreWindow(d->window);
+    d->powerWatch.init(dpy);
+
+    // Without raw motion the pointer is polled every tick
+    d->xiOpcode = selectRawMotion(dpy);
+    if (d->xiOpcode < 0) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "No XInput 2.1 on %s, polling the pointer", name.c_str());
+    }
+
+    XMapRaised(dpy, d->window);
+    XFlush(dpy);
+
+    displays.push_back(d);
+    SDL_Log("Attached display %s", name.c_str());
+    *reply = "ok: attached " + name;
+    return true;
+}
+
+bool CatDaemon::detach(const std::string& name, std::string* reply) {
+    DaemonDisplay* d = findDisplay(name);
+    if (!d) {
+        *reply = "error: " + name + " is not attached";
+        return false;
+    }
+
+    displays.erase(std::find(displays.begin(), displays.end(), d));
+    destroyDisplay(d);
+    SDL_Log("Detached display %s", name.c_str());
+    *reply = "ok: detached " + name;
+    return true;
+}
+
+void CatDaemon::destroyDisplay(DaemonDisplay* d) {
+    // A lost connection only needs its memory released
+    if (!d->lost) {
+        for (XserverRegion region : d->cellRegions) {
+            XFixesDestroyRegion(d->display, region);
+        }
+        if (d->gc) XFreeGC(d->display, d->gc);
+        if (d->sheet) XFreePixmap(d->display, d->sheet);
+        if (d->window) XDestroyWindow(d->display, d->window);
+    }
+    XCloseDisplay(d->display);
+    delete d;
+}
+
+DaemonDisplay* CatDaemon::findDisplay(const std::string& name) const {
+    for (DaemonDisplay* d : displays) {
+        if (d->name == name) {
+            return d;
+        }
+    }
+    return nullptr;
+}
+
+void CatDaemon::pollDisplay(DaemonDisplay* d) {
+    // Drain only what already arrived; never blocks
+    while (!d->lost && XPending(d->display)) {
+        XEvent event;
+        XNextEvent(d->display, &event);
+
+        if (event.type == Expose) {
+            if (event.xexpose.window == d->window) {
+                d->shownCell = -1;
+            }
+            continue;
+        }
+
+        // Only the type matters; Xlib frees the unclaimed cookie data
+        if (event.type == GenericEvent && event.xcookie.extension == d->xiOpcode) {
+            d->pointerMoved = d->pointerMoved || event.xcookie.evtype == XI_RawMotion;
+            continue;
+        }
+
+        // Stay above windows mapped after ours
+        if (event.type == MapNotify && event.xmap.window != d->window) {
+            XRaiseWindow(d->display, d->window);
+        }
+
+        if (!d->powerWatch.handleEvent(event)) {
+            d->windowIndex.handleEvent(event);
+        }
+    }
+}
+
+void CatDaemon::drawCell(DaemonDisplay* d, int cell) {
+    int column = cell % sheetColumns;
+    int row = cell / sheetColumns;
+
+    // Shape first so no stale pixels show outside the new outline
+    if (d->xfixes) {
+        XFixesSetWindowShapeRegion(d->display, d->window, ShapeBounding, 0, 0, d->cellRegions[cell]);
+    } else {
+        std::vector<XRectangle>& rects = cellRects[cell];
+        XShapeCombineRectangles(d->display, d->window, ShapeBounding, 0, 0,
+                                rects.data(), (int)rects.size(), ShapeSet, YXBanded);
+    }
+    XCopyArea(d->display, d->sheet, d->window, d->gc,
+              column * spriteSize, row * spriteSize, spriteSize, spriteSize, 0, 0);
+    d->shownCell = cell;
+}
+
+void CatDaemon::updateDisplay(DaemonDisplay* d, Uint32 currentTime) {
+    if (d->powerWatch.displayOff()) {
+        if (!d->suspended) {
+            SDL_Log("Display %s off, suspending its cat", d->name.c_str());
+            d->suspended = true;
+        }
+        return;
+    }
+
+    // One round trip per tick only when the pointer moved (or can't be watched)
+    if (d->pointerMoved || d->suspended || d->xiOpcode < 0) {
+        Window root = DefaultRootWindow(d->display);
+        Window rootReturn, childReturn;
+        int winX, winY;
+        unsigned int mask;
+        XQueryPointer(d->display, root, &rootReturn, &childReturn, &d->mouseX, &d->mouseY, &winX, &winY, &mask);
+        d->pointerMoved = false;
+    }
+
+    if (d->suspended) {
+        // An idle cat is found asleep after the display was off
+        d->behavior.resume(d->mouseX, d->mouseY, currentTime, true);
+        d->suspended = false;
+    }
+
+    d->behavior.update(d->mouseX, d->mouseY, currentTime);
+
+    // Move only when the cat moved a whole pixel
+    int windowX = (int)(d->behavior.getX() - spriteSize/2);
+    int windowY = (int)(d->behavior.getY() - spriteSize/2);
+    if (windowX != d->windowX || windowY != d->windowY) {
+        XMoveWindow(d->display, d->window, windowX, windowY);
+        d->windowX = windowX;
+        d->windowY = windowY;
+    }
+
+    // Frames that show the same cell cost nothing
+    const FrameDesc& frame = d->behavior.currentFrame();
+    int cell = (frame.src.y / spriteSize) * sheetColumns + frame.src.x / spriteSize;
+    if (cell != d->shownCell) {
+        drawCell(d, cell);
+    }
+    XFlush(d->display);
+}
+
+void CatDaemon::acceptClient() {
+    int fd = accept4(controlFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd >= 0) {
+        ControlClient client = {fd, std::string()};
+        clients.push_back(client);
+    }
+}
+
+bool CatDaemon::serviceClient(ControlClient* client) {
+    char buffer[DAEMON_MAX_COMMAND];
+    ssize_t n = read(client->fd, buffer, sizeof(buffer));
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return true;
+    }
+    if (n <= 0) {
+        return false;
+    }
+    client->input.append(buffer, n);
+
+    size_t newline = client->input.find('\n');
+    if (newline == std::string::npos) {
+        return client->input.size() < DAEMON_MAX_COMMAND;
+    }
+
+    // One command per connection: answer and hang up
+    std::string reply = handleCommand(client->input.substr(0, newline)) + "\n";
+    ssize_t written = write(client->fd, reply.data(), reply.size());
+    (void)written;
+    return false;
+}
+
+std::string CatDaemon::handleCommand(const std::string& command) {
+    std::string verb = command.substr(0, command.find(' '));
+    std::string argument = command.size() > verb.size() ? command.substr(verb.size() + 1) : "";
+    std::string reply;
+
+    if (verb == "attach" && !argument.empty()) {
+        attach(argument, &reply);
+    } else if (verb == "detach" && !argument.empty()) {
+        detach(argument, &reply);
+    } else if (verb == "list") {
+        reply = "ok:";
+        for (DaemonDisplay* d : displays) {
+            reply += " " + d->name;
+        }
+    } else if (verb == "quit") {
+        stopRequested = 1;
+        reply = "ok: quitting";
+    } else {
+        reply = "error: unknown command '" + command + "'";
+    }
+    return reply;
+}
+
+bool CatDaemon::run() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);  // Clients may hang up before their reply
+
+    const Uint32 frameDelay = 1000 / FPS;
+    Uint32 nextTick = SDL_GetTicks();
+
+    while (!stopRequested) {
+        // Nothing to serve and no way to be given anything: don't block forever
+        if (displays.empty() && controlFd < 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No displays attached and no control socket, stopping");
+            return false;
+        }
+
+        // Events already queued by Xlib never show up as readable descriptors
+        bool queued = false;
+        bool awake = false;
+        for (DaemonDisplay* d : displays) {
+            queued = queued || (!d->lost && QLength(d->display) > 0);
+            awake = awake || !d->suspended;
+        }
+
+        fd_set fds;
+        FD_ZERO(&fds);
+        int maxFd = -1;
+        for (DaemonDisplay* d : displays) {
+            if (d->lost) continue;
+            FD_SET(ConnectionNumber(d->display), &fds);
+            maxFd = std::max(maxFd, ConnectionNumber(d->display));
+        }
+        if (controlFd >= 0) {
+            FD_SET(controlFd, &fds);
+            maxFd = std::max(maxFd, controlFd);
+        }
+        for (ControlClient& client : clients) {
+            FD_SET(client.fd, &fds);
+            maxFd = std::max(maxFd, client.fd);
+        }
+
+        // With every display off (or none attached) sleep until something happens
+        Uint32 now = SDL_GetTicks();
+        Uint32 waitMs = queued ? 0 : ((Sint32)(nextTick - now) > 0 ? nextTick - now : 0);
+        struct timeval timeout = {(time_t)(waitMs / 1000), (suseconds_t)(waitMs % 1000) * 1000};
+        int ready = select(maxFd + 1, &fds, nullptr, nullptr, (awake || queued) ? &timeout : nullptr);
+        if (ready < 0 && errno != EINTR) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "select failed: %s", strerror(errno));
+            break;
+        }
+
+        if (ready > 0) {
+            if (controlFd >= 0 && FD_ISSET(controlFd, &fds)) {
+                acceptClient();
+            }
+            for (size_t i = 0; i < clients.size(); ) {
+                if (FD_ISSET(clients[i].fd, &fds) && !serviceClient(&clients[i])) {
+                    close(clients[i].fd);
+                    clients.erase(clients.begin() + i);
+                } else {
+                    i++;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < displays.size(); ) {
+            DaemonDisplay* d = displays[i];
+            pollDisplay(d);
+            if (d->lost) {
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Lost display %s, detaching", d->name.c_str());
+                displays.erase(displays.begin() + i);
+                destroyDisplay(d);
+            } else {
+                i++;
+            }
+        }
+
+        now = SDL_GetTicks();
+        if ((Sint32)(now - nextTick) < 0) {
+            continue;
+        }
+
+        for (DaemonDisplay* d : displays) {
+            updateDisplay(d, now);
+        }
+
+        // Skip ticks we slept through instead of bursting to catch up
+        nextTick += frameDelay;
+        if ((Sint32)(now - nextTick) >= 0) {
+            nextTick = now + frameDelay;
+        }
+    }
+
+    SDL_Log("Daemon stopping");
+    return true;
+}
+
+bool CatDaemon::sendCommand(const std::string& command) {
+    std::string path;
+    if (!controlSocketPath(&path)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "XDG_RUNTIME_DIR is not set");
+        return false;
+    }
+
+    sockaddr_un addr = socketAddress(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No daemon listening on %s", path.c_str());
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    std::string line = command + "\n";
+    bool sent = write(fd, line.data(), line.size()) == (ssize_t)line.size();
+
+    std::string reply;
+    char buffer[256];
+    ssize_t n;
+    while (sent && (n = read(fd, buffer, sizeof(buffer))) > 0) {
+        reply.append(buffer, n);
+    }
+    close(fd);
+
+    fputs(reply.c_str(), stdout);
+    return reply.compare(0, 3, "ok:") == 0;
+}
@@ -0,0 +1,145 @@
+#include "include/cpu_governor.h"
+#include <sys/resource.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+const char* const FIDELITY_NAMES[FIDELITY_COUNT] = {"full", "coarse", "frozen", "half-rate", "third-rate"};
+
+const char* const GOVERNOR_COUNTER_NAMES[GOVERNOR_COUNTER_COUNT] = {
+    "step-down", "step-up", "on-battery", "on-ac", "redraw-skipped", "move-deferred"
+};
+
+// CPU time of every thread in the process (SDL's included)
+Uint64 processCpuNs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0) {
+        return (Uint64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return ((Uint64)usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ull +
+           ((Uint64)usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ull;
+}
+
+}  // namespace
+
+CpuGovernor::CpuGovernor() : budget(0), onBattery(false), nextPowerPoll(0), level(FIDELITY_FULL),
+                             sampleCount(0), sampleHead(0), nextSample(0), lastUsage(0) {
+    memset(counters, 0, sizeof(counters));
+}
+
+bool CpuGovernor::enable(double budgetPercent, const char* powerSupplyPath) {
+    if (!(budgetPercent > 0)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CPU budget must be a positive percentage");
+        return false;
+    }
+
+    budget = budgetPercent / 100.0;
+    powerPath = powerSupplyPath ? powerSupplyPath : POWER_SUPPLY_ONLINE_PATH;
+
+    Uint32 now = SDL_GetTicks();
+    pollPower(now);
+    reset(now);
+    SDL_Log("CPU budget %.3f%% of a core (%.3f%% on battery, AC state from %s)",
+            budgetPercent, budgetPercent * CPU_BUDGET_BATTERY_SCALE, powerPath.c_str());
+    return true;
+}
+
+void CpuGovernor::pollPower(Uint32 now) {
+    nextPowerPoll = now + GOVERNOR_POWER_POLL_MS;
+
+    // No such file (desktops, VMs) counts as AC
+    bool battery = false;
+    FILE* file = fopen(powerPath.c_str(), "r");
+    if (file) {
+        battery = fgetc(file) == '0';
+        fclose(file);
+    }
+
+    if (battery != onBattery) {
+        onBattery = battery;
+        counters[battery ? GOVERNOR_ON_BATTERY : GOVERNOR_ON_AC]++;
+        SDL_Log("On %s power, CPU budget %.3f%% of a core, fidelity %s (%llu battery, %llu AC switches)",
+                battery ? "battery" : "AC", 100.0 * budget * (battery ? CPU_BUDGET_BATTERY_SCALE : 1.0),
+                FIDELITY_NAMES[level], counters[GOVERNOR_ON_BATTERY], counters[GOVERNOR_ON_AC]);
+    }
+}
+
+void CpuGovernor::reset(Uint32 now) {
+    sampleCount = 0;
+    if (budget > 0) {
+        takeSample(now);
+    }
+}
+
+void CpuGovernor::takeSample(Uint32 now) {
+    const int slots = GOVERNOR_WINDOW_SAMPLES + 1;
+    nextSample = now + GOVERNOR_SAMPLE_MS;
+
+    if ((Sint32)(now - nextPowerPoll) >= 0) {
+        pollPower(now);
+    }
+
+    sampleHead = (sampleHead + 1) % slots;
+    sampleWall[sampleHead] = now;
+    sampleCpu[sampleHead] = processCpuNs();
+    if (sampleCount < slots) {
+        sampleCount++;
+    }
+
+    int periods = sampleCount - 1;
+    int oldest = (sampleHead - periods + slots) % slots;
+    Uint32 wallMs = now - sampleWall[oldest];
+    if (periods == 0 || wallMs == 0) {
+        return;
+    }
+    lastUsage = (sampleCpu[sampleHead] - sampleCpu[oldest]) / (wallMs * 1e6);
+
+    double effective = onBattery ? budget * CPU_BUDGET_BATTERY_SCALE : budget;
+    if (periods >= GOVERNOR_MIN_SAMPLES && lastUsage > effective && level + 1 < FIDELITY_COUNT) {
+        setLevel((Fidelity)(level + 1), GOVERNOR_STEP_DOWN, wallMs / 1000.0);
+    } else if (periods >= GOVERNOR_WINDOW_SAMPLES && lastUsage < effective * CPU_BUDGET_HEADROOM &&
+               level > FIDELITY_FULL) {
+        setLevel((Fidelity)(level - 1), GOVERNOR_STEP_UP, wallMs / 1000.0);
+    }
+}
+
+void CpuGovernor::setLevel(Fidelity next, GovernorCounter reason, double seconds) {
+    counters[reason]++;
+
+    // The counters so far show what the level being left actually saved
+    SDL_Log("CPU %.3f%% of a core over %.1fs, fidelity %s -> %s "
+            "(%llu down, %llu up, %llu redraws skipped, %llu moves deferred)",
+            100.0 * lastUsage, seconds, FIDELITY_NAMES[level], FIDELITY_NAMES[next],
+            counters[GOVERNOR_STEP_DOWN], counters[GOVERNOR_STEP_UP],
+            counters[GOVERNOR_REDRAW_SKIPPED], counters[GOVERNOR_MOVE_DEFERRED]);
+    level = next;
+
+    // Judge the new level on its own cost: the newest sample starts the window
+    sampleCount = 1;
+}
+
+int CpuGovernor::tickDivisor() const {
+    switch (level) {
+        case FIDELITY_HALF_RATE:  return 2;
+        case FIDELITY_THIRD_RATE: return 3;
+        default:                  return 1;
+    }
+}
+
+void CpuGovernor::report() const {
+    if (budget <= 0) {
+        return;
+    }
+
+    SDL_Log("CPU governor: budget %.3f%% of a core%s, last window %.3f%%, fidelity %s",
+            100.0 * budget * (onBattery ? CPU_BUDGET_BATTERY_SCALE : 1.0), onBattery ? " (battery)" : "",
+            100.0 * lastUsage, FIDELITY_NAMES[level]);
+    for (int c = 0; c < GOVERNOR_COUNTER_COUNT; c++) {
+        SDL_Log("  %-14s %12llu", GOVERNOR_COUNTER_NAMES[c], counters[c]);
+    }
+}
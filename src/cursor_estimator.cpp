@@ -0,0 +1,51 @@
+#include "include/cursor_estimator.h"
+
+CursorEstimator::CursorEstimator() : x(0.0), y(0.0), vx(0.0), vy(0.0), lastTime(0), primed(false) {
+}
+
+void CursorEstimator::reset(double sampleX, double sampleY, Uint32 now) {
+    x = sampleX;
+    y = sampleY;
+    vx = 0.0;
+    vy = 0.0;
+    lastTime = now;
+    primed = true;
+}
+
+void CursorEstimator::addSample(double sampleX, double sampleY, Uint32 now) {
+    Uint32 dt = now - lastTime;
+    if (!primed || dt > CURSOR_MAX_SAMPLE_GAP_MS) {
+        reset(sampleX, sampleY, now);
+        return;
+    }
+    if (dt == 0) {
+        // Same instant: take the newer position, keep the velocity
+        x = sampleX;
+        y = sampleY;
+        return;
+    }
+
+    // Predict to the sample time, then correct by the residual
+    double predX = x + vx * dt;
+    double predY = y + vy * dt;
+    double residualX = sampleX - predX;
+    double residualY = sampleY - predY;
+
+    x = predX + CURSOR_FILTER_ALPHA * residualX;
+    y = predY + CURSOR_FILTER_ALPHA * residualY;
+    vx += CURSOR_FILTER_BETA * residualX / dt;
+    vy += CURSOR_FILTER_BETA * residualY / dt;
+    lastTime = now;
+}
+
+void CursorEstimator::predict(Uint32 at, double* predictedX, double* predictedY) const {
+    int lead = (int)(at - lastTime);
+    if (lead < 0) {
+        lead = 0;
+    } else if (lead > (int)CURSOR_MAX_LEAD_MS) {
+        lead = CURSOR_MAX_LEAD_MS;
+    }
+
+    *predictedX = x + vx * lead;
+    *predictedY = y + vy * lead;
+}
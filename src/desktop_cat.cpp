@@ -5,14 +5,44 @@
 #include <ctime>
 #include <algorithm>
 #include <dirent.h>
+#include <cerrno>
+#include <sys/select.h>
+#include <X11/extensions/XInput2.h>
+#include <X11/extensions/XI.h>
+
+namespace {
+
+Display* eventDisplay = nullptr;
+XErrorHandler previousErrorHandler = nullptr;
+int xiErrorBase = -1;  // First XInput error code on eventDisplay, -1 without XI2
+
+// Windows and pointer devices can vanish between an event and our follow-up
+// query on the event connection; those errors are expected. Anything else is
+// a bug and goes to the previous handler.
+int handleX11Error(Display* display, XErrorEvent* error) {
+    if (display == eventDisplay &&
+        (error->error_code == BadWindow ||
+         (xiErrorBase >= 0 && error->error_code == xiErrorBase + XI_BadDevice))) {
+        return 0;
+    }
+    return previousErrorHandler ? previousErrorHandler(display, error) : 0;
+}
 
-void DesktopCat::loadAvailablePalettes() {
-    spritePalettes.clear();
+}  // namespace
+
+CatInstance::CatInstance(int deviceId, const CatBehavior& behavior)
+    : deviceId(deviceId), window(nullptr), renderer(nullptr), spriteSheet(nullptr),
+      x11Window(0), lastShape(nullptr), drawnFrame(nullptr), windowX(0), windowY(0), mouseX(0), mouseY(0),
+      motionPending(false), hidden(false), hiddenSince(0), behavior(behavior) {
+}
+
+std::vector<std::string> findSpritePalettes() {
+    std::vector<std::string> palettes;
 
     DIR* dir = opendir(SPRITE_DIR);
     if (!dir) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to open sprite directory: %s", SPRITE_DIR);
-        return;
+        return palettes;
     }
 
     struct dirent* entry;
@@ -25,13 +55,18 @@ void DesktopCat::loadAvailablePalettes() {
             filename.substr(filename.length() - 4) == ".png") {
 
             std::string fullPath = std::string(SPRITE_DIR) + filename;
-            spritePalettes.push_back(fullPath);
+            palettes.push_back(fullPath);
         }
     }
     closedir(dir);
 
     // Sort palettes alphabetically for consistent ordering
-    std::sort(spritePalettes.begin(), spritePalettes.end());
+    std::sort(palettes.begin(), palettes.end());
+    return palettes;
+}
+
+void DesktopCat::loadAvailablePalettes() {
+    spritePalettes = findSpritePalettes();
 
     if (spritePalettes.empty()) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No sprite palettes found in %s", SPRITE_DIR);
@@ -44,44 +79,62 @@ void DesktopCat::loadAvailablePalettes() {
 }
 
 bool DesktopCat::loadSpriteSheet(const char* path) {
-    SDL_Surface* surface = IMG_Load(path);
-    if (!surface) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load sprite: %s", IMG_GetError());
+    // Mapped from another session's decode when possible
+    MappedSheet* mapped = nullptr;
+    SDL_Surface* converted = sheetCache.load(path, &mapped);
+    if (!converted) {
         return false;
     }
 
-    // Free old resources if they exist
-    if (spriteSheet) {
-        SDL_DestroyTexture(spriteSheet);
-        spriteSheet = nullptr;
+    // Textures belong to a renderer, so every cat gets its own copy of the shared surface.
+    // Create them all before touching the current sheet so a failure leaves it in use.
+    std::vector<SDL_Texture*> textures;
+    for (CatInstance* cat : cats) {
+        SDL_Texture* texture = createSheetTexture(cat->renderer, converted);
+        if (!texture) {
+            for (SDL_Texture* created : textures) {
+                SDL_DestroyTexture(created);
+            }
+            SDL_FreeSurface(converted);
+            delete mapped;
+            return false;
+        }
+        textures.push_back(texture);
+    }
+
+    for (size_t i = 0; i < cats.size(); i++) {
+        if (cats[i]->spriteSheet) {
+            SDL_DestroyTexture(cats[i]->spriteSheet);
+        }
+        cats[i]->spriteSheet = textures[i];
     }
+
+    // Free old resources if they exist; the surface goes before the mapping under it
     if (spriteSheetSurface) {
         SDL_FreeSurface(spriteSheetSurface);
-        spriteSheetSurface = nullptr;
     }
+    delete mappedSheet;
+    mappedSheet = mapped;
+    spriteSheetSurface = converted;
+    spriteSize = detectFrameSize(converted->w, converted->h);
+    kernels = spriteKernelsFor(spriteSize);
 
-    // Convert surface to RGBA for proper transparency
-    spriteSheetSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
-    SDL_FreeSurface(surface);
-
-    if (!spriteSheetSurface) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to convert surface: %s", SDL_GetError());
-        return false;
-    }
+    return true;
+}
 
+SDL_Texture* DesktopCat::createSheetTexture(SDL_Renderer* renderer, SDL_Surface* surface) {
     // Create texture from surface
-    spriteSheet = SDL_CreateTextureFromSurface(renderer, spriteSheetSurface);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 
-    if (!spriteSheet) {
+    if (!texture) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create texture: %s", SDL_GetError());
-        SDL_FreeSurface(spriteSheetSurface);
-        return false;
+        return nullptr;
     }
 
     // Enable alpha blending on the texture
-    SDL_SetTextureBlendMode(spriteSheet, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
 
-    return true;
+    return texture;
 }
 
 void DesktopCat::swapPalette() {
@@ -91,530 +144,561 @@ void DesktopCat::swapPalette() {
     }
 
     // Cycle to next palette
-    currentPaletteIndex = (currentPaletteIndex + 1) % spritePalettes.size();
+    int nextIndex = (currentPaletteIndex + 1) % spritePalettes.size();
 
-    SDL_Log("Swapping to palette [%d]: %s", currentPaletteIndex, spritePalettes[currentPaletteIndex].c_str());
+    SDL_Log("Swapping to palette [%d]: %s", nextIndex, spritePalettes[nextIndex].c_str());
 
-    // Free old sprite masks
-    if (x11Display) {
-        for (auto& pair : spriteMasks) {
-            XFreePixmap(x11Display, pair.second);
-        }
-        spriteMasks.clear();
+    // Load first: on failure the current sheet, its shapes and the frame table stay valid
+    if (!loadSpriteSheet(spritePalettes[nextIndex].c_str())) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load palette: %s, keeping the current one",
+                     spritePalettes[nextIndex].c_str());
+        return;
     }
+    currentPaletteIndex = nextIndex;
 
-    // Reload sprite sheet with new palette
-    if (!loadSpriteSheet(spritePalettes[currentPaletteIndex].c_str())) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load palette: %s", spritePalettes[currentPaletteIndex].c_str());
-        return;
+    // Rebuild frame table and sprite shapes for new palette
+    freeSpriteShapes();
+    buildFrameTable();
+
+    // Reset last shape to force transparency update; palettes may differ in cell size
+    for (CatInstance* cat : cats) {
+        cat->lastShape = nullptr;
+        cat->drawnFrame = nullptr;
+        cat->windowX = (int)(cat->behavior.getX() - spriteSize/2);
+        cat->windowY = (int)(cat->behavior.getY() - spriteSize/2);
+        SDL_SetWindowSize(cat->window, spriteSize, spriteSize);
+        SDL_SetWindowPosition(cat->window, cat->windowX, cat->windowY);
     }
+}
 
-    // Regenerate sprite masks for new palette
-    if (x11Ready) {
-        generateAllSpriteMasks();
+void DesktopCat::buildSpriteShape(const SpriteFrame& sprite, SpriteShape* shape) {
+    // Shared sheets come with every cell's shape already packed
+    if (!mappedSheet || !mappedSheet->cellShape(sprite.x, sprite.y, &shape->rects)) {
+        // Lock surface for pixel access
+        SDL_LockSurface(spriteSheetSurface);
+        const Uint8* cell = (const Uint8*)spriteSheetSurface->pixels +
+                            sprite.y * spriteSize * spriteSheetSurface->pitch + sprite.x * spriteSize * 4;
+        kernels->packShape(cell, spriteSheetSurface->pitch, &shape->rects);
+        SDL_UnlockSurface(spriteSheetSurface);
     }
 
-    // Reset last sprite to force transparency update
-    lastSprite = {-1, -1};
+    // Convert once to a server-side region so reshaping is a plain region swap
+    shape->region = None;
+    if (xfixesReady) {
+        shape->region = XFixesCreateRegion(x11Display, shape->rects.data(), (int)shape->rects.size());
+    }
 }
 
-Pixmap DesktopCat::createSpriteMask(const SpriteFrame& sprite) {
-    // Create a pixmap for the shape mask (use root window for 1-bit depth)
-    Pixmap mask = XCreatePixmap(x11Display, DefaultRootWindow(x11Display), SPRITE_SIZE, SPRITE_SIZE, 1);
-    if (!mask) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create pixmap for transparency");
-        return 0;
+void DesktopCat::freeSpriteShapes() {
+    if (x11Display) {
+        for (SpriteShape& shape : cellShapes) {
+            if (shape.region) {
+                XFixesDestroyRegion(x11Display, shape.region);
+            }
+        }
     }
+    cellShapes.clear();
+}
 
-    GC gc = XCreateGC(x11Display, mask, 0, NULL);
+void DesktopCat::buildFrameTable() {
+    int sheetColumns = spriteSheetSurface->w / spriteSize;
+    int sheetRows = spriteSheetSurface->h / spriteSize;
+    cellShapes.assign(sheetColumns * sheetRows, SpriteShape());
 
-    // Clear the mask (all transparent)
-    XSetForeground(x11Display, gc, 0);
-    XFillRectangle(x11Display, mask, gc, 0, 0, SPRITE_SIZE, SPRITE_SIZE);
+    fillFrameTable(frameTable, spriteSize);
+    if (!x11Ready) {
+        return;
+    }
 
-    // Set opaque pixels based on alpha channel
-    XSetForeground(x11Display, gc, 1);
+    // Generate each cell's shape once, no matter how many entries share it
+    for (int i = 0; i < FRAME_TABLE_SIZE; i++) {
+        FrameDesc& entry = frameTable[i];
+        SpriteFrame cell = {entry.src.x / spriteSize, entry.src.y / spriteSize};
+        if (cell.x >= sheetColumns || cell.y >= sheetRows) {
+            continue;
+        }
 
-    // Extract sprite region
-    SDL_Rect srcRect = {
-        sprite.x * SPRITE_SIZE,
-        sprite.y * SPRITE_SIZE,
-        SPRITE_SIZE,
-        SPRITE_SIZE
-    };
+        SpriteShape& shape = cellShapes[cell.y * sheetColumns + cell.x];
+        if (shape.rects.empty() && !shape.region) {
+            buildSpriteShape(cell, &shape);
+        }
+        entry.shape = &shape;
+    }
+}
 
-    // Lock surface for pixel access
-    SDL_LockSurface(spriteSheetSurface);
-    Uint32* pixels = (Uint32*)spriteSheetSurface->pixels;
-    int pitch = spriteSheetSurface->pitch / 4;
+void DesktopCat::setX11Transparency(CatInstance* cat, const FrameDesc& frame) {
+    if (!x11Ready || !cat->x11Window) {
+        return;  // X11 not ready yet
+    }
 
-    // Create mask from alpha channel
-    for (int y = 0; y < SPRITE_SIZE; y++) {
-        for (int x = 0; x < SPRITE_SIZE; x++) {
-            int sx = srcRect.x + x;
-            int sy = srcRect.y + y;
-            Uint32 pixel = pixels[sy * pitch + sx];
+    // Only update transparency if the shape has changed
+    if (frame.shape == cat->lastShape || !frame.shape) {
+        return;  // Same shape, no need to update
+    }
 
-            Uint8 r, g, b, a;
-            SDL_GetRGBA(pixel, spriteSheetSurface->format, &r, &g, &b, &a);
+    cat->lastShape = frame.shape;
 
-            // If alpha > 128, make it opaque in the mask
-            if (a > 128) {
-                XDrawPoint(x11Display, mask, gc, x, y);
-            }
-        }
+    // Apply the pre-built shape; without XFixes send the rectangles instead of a bitmap
+    if (frame.shape->region) {
+        XFixesSetWindowShapeRegion(x11Display, cat->x11Window, ShapeBounding, 0, 0, frame.shape->region);
+    } else {
+        XShapeCombineRectangles(x11Display, cat->x11Window, ShapeBounding, 0, 0,
+                                const_cast<XRectangle*>(frame.shape->rects.data()),
+                                (int)frame.shape->rects.size(), ShapeSet, YXBanded);
     }
+}
+
+void DesktopCat::drawSprite(CatInstance* cat, const FrameDesc& frame) {
+    SDL_Rect dstRect = {0, 0, spriteSize, spriteSize};
 
-    SDL_UnlockSurface(spriteSheetSurface);
-    XFreeGC(x11Display, gc);
+    // Apply X11 transparency BEFORE rendering
+    counters.mark(PHASE_SHAPE);
+    setX11Transparency(cat, frame);
+    counters.mark(PHASE_PRESENT);
+
+    // Clear renderer with transparent background
+    SDL_SetRenderDrawColor(cat->renderer, 0, 0, 0, 0);
+    SDL_RenderClear(cat->renderer);
 
-    return mask;
+    // Render sprite directly from texture
+    SDL_RenderCopy(cat->renderer, cat->spriteSheet, &frame.src, &dstRect);
+    SDL_RenderPresent(cat->renderer);
+    counters.mark(PHASE_UPDATE);
 }
 
-void DesktopCat::generateAllSpriteMasks() {
-    using namespace SpriteFrames;
-
-    // Generate masks for all unique sprites
-    const SpriteFrame* allSprites[] = {
-        &ALERT_FRAME,
-        &TIRED_FRAME,
-        &PAWUP_FRAME,
-        &IDLE_FRAME,
-        SLEEPING_FRAMES, SLEEPING_FRAMES + 1,
-        ITCH_FRAMES, ITCH_FRAMES + 1,
-        SCRATCH_NORTH, SCRATCH_NORTH + 1,
-        SCRATCH_EAST, SCRATCH_EAST + 1,
-        SCRATCH_SOUTH, SCRATCH_SOUTH + 1,
-        SCRATCH_WEST, SCRATCH_WEST + 1,
-        RUN_NORTH, RUN_NORTH + 1,
-        RUN_NORTHEAST, RUN_NORTHEAST + 1,
-        RUN_EAST, RUN_EAST + 1,
-        RUN_SOUTHEAST, RUN_SOUTHEAST + 1,
-        RUN_SOUTH, RUN_SOUTH + 1,
-        RUN_SOUTHWEST, RUN_SOUTHWEST + 1,
-        RUN_WEST, RUN_WEST + 1,
-        RUN_NORTHWEST, RUN_NORTHWEST + 1
-    };
-
-    for (const SpriteFrame* sprite : allSprites) {
-        std::pair<int, int> key = std::make_pair(sprite->x, sprite->y);
-        if (spriteMasks.find(key) == spriteMasks.end()) {
-            Pixmap mask = createSpriteMask(*sprite);
-            if (mask) {
-                spriteMasks[key] = mask;
+CatInstance* DesktopCat::spawnCat(int deviceId) {
+    int mouse_x = 0, mouse_y = 0;
+    queryPointer(deviceId, &mouse_x, &mouse_y);
+
+    // Find which display contains this cat's pointer
+    int numDisplays = SDL_GetNumVideoDisplays();
+    SDL_Rect displayBounds;
+    double startX = 400;  // Fallback to default position if display detection fails
+    double startY = 300;
+
+    for (int i = 0; i < numDisplays; i++) {
+        if (SDL_GetDisplayBounds(i, &displayBounds) == 0) {
+            if (mouse_x >= displayBounds.x && mouse_x < displayBounds.x + displayBounds.w &&
+                mouse_y >= displayBounds.y && mouse_y < displayBounds.y + displayBounds.h) {
+                // Pointer is on this display, position cat at center of display
+                startX = displayBounds.x + displayBounds.w / 2.0;
+                startY = displayBounds.y + displayBounds.h / 2.0;
+                break;
             }
         }
     }
-}
 
-void DesktopCat::setX11Transparency(const SpriteFrame& sprite) {
-    if (!x11Ready) {
-        return;  // X11 not ready yet
+    CatInstance* cat = new CatInstance(deviceId, CatBehavior(frameTable, &windowIndex, startX, startY,
+                                                             mouse_x, mouse_y, SDL_GetTicks()));
+    cat->mouseX = mouse_x;
+    cat->mouseY = mouse_y;
+    cat->windowX = (int)(startX - spriteSize/2);
+    cat->windowY = (int)(startY - spriteSize/2);
+
+    // Create window for transparency
+    cat->window = SDL_CreateWindow("Desktop Cat",
+                                   cat->windowX, cat->windowY,
+                                   spriteSize, spriteSize,
+                                   SDL_WINDOW_BORDERLESS |
+                                   SDL_WINDOW_ALWAYS_ON_TOP |
+                                   SDL_WINDOW_SKIP_TASKBAR);
+
+    if (!cat->window) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Window creation failed: %s", SDL_GetError());
+        destroyCat(cat);
+        return nullptr;
     }
 
-    // Only update transparency if sprite has changed
-    if (sprite.x == lastSprite.x && sprite.y == lastSprite.y) {
-        return;  // Same sprite, no need to update
+    // No vsync: each cat presents in turn, and waiting a vblank per window would add up
+    cat->renderer = SDL_CreateRenderer(cat->window, -1, SDL_RENDERER_ACCELERATED);
+
+    if (!cat->renderer) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Renderer creation failed: %s", SDL_GetError());
+        destroyCat(cat);
+        return nullptr;
     }
 
-    lastSprite = sprite;
+    SDL_SetRenderDrawBlendMode(cat->renderer, SDL_BLENDMODE_BLEND);
 
-    // Look up the pre-cached mask
-    std::pair<int, int> key = std::make_pair(sprite.x, sprite.y);
-    auto it = spriteMasks.find(key);
-    if (it != spriteMasks.end()) {
-        // Apply the pre-cached shape mask to the window
-        XShapeCombineMask(x11Display, x11Window, ShapeBounding, 0, 0, it->second, ShapeSet);
+    if (spriteSheetSurface) {
+        cat->spriteSheet = createSheetTexture(cat->renderer, spriteSheetSurface);
+        if (!cat->spriteSheet) {
+            destroyCat(cat);
+            return nullptr;
+        }
     }
-}
 
-void DesktopCat::drawSprite(const SpriteFrame& sprite) {
-    SDL_Rect srcRect = {
-        sprite.x * SPRITE_SIZE,
-        sprite.y * SPRITE_SIZE,
-        SPRITE_SIZE,
-        SPRITE_SIZE
-    };
+    // Get X11 window handle for transparency (after everything is initialized)
+    SDL_SysWMinfo wmInfo;
+    SDL_VERSION(&wmInfo.version);
+    if (SDL_GetWindowWMInfo(cat->window, &wmInfo)) {
+        cat->x11Window = wmInfo.info.x11.window;
+
+        // All SDL windows share one connection; the first cat sets it up
+        if (!x11Ready) {
+            x11Display = wmInfo.info.x11.display;
+
+            // Window shape regions need XFixes 2.0 or newer
+            int fixesEvent, fixesError, fixesMajor = 0, fixesMinor = 0;
+            if (XFixesQueryExtension(x11Display, &fixesEvent, &fixesError) &&
+                XFixesQueryVersion(x11Display, &fixesMajor, &fixesMinor) && fixesMajor >= 2) {
+                xfixesReady = true;
+            } else {
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "XFixes 2.0 unavailable, shaping with rectangle lists");
+            }
+
+            // Mark X11 as ready for transparency operations
+            x11Ready = true;
+        }
 
-    SDL_Rect dstRect = {0, 0, SPRITE_SIZE, SPRITE_SIZE};
+        // Ensure X11 window is fully created and sync
+        XSync(x11Display, False);
 
-    // Apply X11 transparency BEFORE rendering
-    setX11Transparency(sprite);
+        // The cat is not an obstacle for itself or the others
+        windowIndex.ignoreWindow(cat->x11Window);
+    } else {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to get X11 window info, transparency disabled: %s", SDL_GetError());
+    }
 
-    // Clear renderer with transparent background
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-    SDL_RenderClear(renderer);
+    cats.push_back(cat);
+    SDL_Log("Cat %d following pointer %d", (int)cats.size(), deviceId);
+    return cat;
+}
 
-    // Render sprite directly from texture
-    SDL_RenderCopy(renderer, spriteSheet, &srcRect, &dstRect);
-    SDL_RenderPresent(renderer);
+void DesktopCat::destroyCat(CatInstance* cat) {
+    if (cat->spriteSheet) SDL_DestroyTexture(cat->spriteSheet);
+    if (cat->renderer) SDL_DestroyRenderer(cat->renderer);
+    if (cat->window) SDL_DestroyWindow(cat->window);
+    delete cat;
 }
 
-Direction DesktopCat::calculateDirection(double dx, double dy) {
-    double dist = sqrt(dx * dx + dy * dy);
-    if (dist < 0.1) return direction;
-
-    double nx = dx / dist;
-    double ny = dy / dist;
-
-    // Determine direction based on normalized vector
-    if (ny < -0.5) {
-        if (nx > 0.5) return NORTHEAST;
-        if (nx < -0.5) return NORTHWEST;
-        return NORTH;
-    } else if (ny > 0.5) {
-        if (nx > 0.5) return SOUTHEAST;
-        if (nx < -0.5) return SOUTHWEST;
-        return SOUTH;
-    } else {
-        if (nx > 0) return EAST;
-        return WEST;
+void DesktopCat::removeCat(int deviceId) {
+    for (size_t i = 0; i < cats.size(); i++) {
+        if (cats[i]->deviceId == deviceId) {
+            SDL_Log("Pointer %d removed, cat leaves", deviceId);
+            destroyCat(cats[i]);
+            cats.erase(cats.begin() + i);
+            return;
+        }
     }
 }
 
-const SpriteFrame* DesktopCat::getCurrentRunFrames() {
-    using namespace SpriteFrames;
-    switch (direction) {
-        case NORTH: return RUN_NORTH;
-        case NORTHEAST: return RUN_NORTHEAST;
-        case EAST: return RUN_EAST;
-        case SOUTHEAST: return RUN_SOUTHEAST;
-        case SOUTH: return RUN_SOUTH;
-        case SOUTHWEST: return RUN_SOUTHWEST;
-        case WEST: return RUN_WEST;
-        case NORTHWEST: return RUN_NORTHWEST;
-        default: return RUN_SOUTH;
+bool DesktopCat::initXInput() {
+    if (!x11EventDisplay) {
+        return false;
     }
+
+    int event, error;
+    if (!XQueryExtension(x11EventDisplay, "XInputExtension", &xiOpcode, &event, &error)) {
+        xiOpcode = -1;
+        return false;
+    }
+    xiErrorBase = error;
+
+    int major = 2, minor = 2;
+    if (XIQueryVersion(x11EventDisplay, &major, &minor) != Success || major < 2) {
+        xiOpcode = -1;
+        return false;
+    }
+
+    // From XI 2.1 raw events reach root window selections without a grab
+    xiRawMotion = major > 2 || minor >= 1;
+
+    // Hierarchy changes add and remove cats; raw motion says which pointer to re-sample
+    unsigned char bits[XIMaskLen(XI_LASTEVENT)];
+    memset(bits, 0, sizeof(bits));
+    XISetMask(bits, XI_HierarchyChanged);
+    if (xiRawMotion) {
+        XISetMask(bits, XI_RawMotion);
+    }
+
+    XIEventMask mask;
+    mask.deviceid = XIAllDevices;
+    mask.mask_len = sizeof(bits);
+    mask.mask = bits;
+    XISelectEvents(x11EventDisplay, DefaultRootWindow(x11EventDisplay), &mask, 1);
+
+    refreshSlaveMasters();
+
+    // One cat per master pointer
+    int count = 0;
+    XIDeviceInfo* devices = XIQueryDevice(x11EventDisplay, XIAllMasterDevices, &count);
+    for (int i = 0; i < count; i++) {
+        if (devices[i].use == XIMasterPointer) {
+            spawnCat(devices[i].deviceid);
+        }
+    }
+    if (devices) {
+        XIFreeDeviceInfo(devices);
+    }
+
+    return true;
 }
 
-const SpriteFrame* DesktopCat::getCurrentScratchFrames() {
-    using namespace SpriteFrames;
-    // Simplify to 4 directions for scratch (N, E, S, W)
-    switch (direction) {
-        case NORTH:
-        case NORTHEAST:
-        case NORTHWEST:
-            return SCRATCH_NORTH;
-        case EAST:
-        case SOUTHEAST:
-            return SCRATCH_EAST;
-        case SOUTH:
-            return SCRATCH_SOUTH;
-        case WEST:
-        case SOUTHWEST:
-        default:
-            return SCRATCH_WEST;
+void DesktopCat::refreshSlaveMasters() {
+    slaveMasters.clear();
+
+    int count = 0;
+    XIDeviceInfo* devices = XIQueryDevice(x11EventDisplay, XIAllDevices, &count);
+    for (int i = 0; i < count; i++) {
+        if (devices[i].use == XISlavePointer) {
+            slaveMasters[devices[i].deviceid] = devices[i].attachment;
+        }
+    }
+    if (devices) {
+        XIFreeDeviceInfo(devices);
     }
 }
 
-void DesktopCat::update() {
-    using namespace SpriteFrames;
+void DesktopCat::handleXInputEvent(XGenericEventCookie* cookie) {
+    if (cookie->evtype == XI_HierarchyChanged) {
+        const XIHierarchyEvent* event = (const XIHierarchyEvent*)cookie->data;
 
-    int mouse_x, mouse_y;
-    SDL_GetGlobalMouseState(&mouse_x, &mouse_y);
+        for (int i = 0; i < event->num_info; i++) {
+            const XIHierarchyInfo& info = event->info[i];
+            if ((info.flags & XIMasterAdded) && info.use == XIMasterPointer) {
+                spawnCat(info.deviceid);
+            } else if (info.flags & XIMasterRemoved) {
+                removeCat(info.deviceid);
+            }
+        }
 
-    // Calculate distance from cat to mouse
-    double dx = mouse_x - x;
-    double dy = mouse_y - y;
-    double distance = sqrt(dx * dx + dy * dy);
+        // Slaves may have moved between masters
+        refreshSlaveMasters();
+    } else if (cookie->evtype == XI_RawMotion) {
+        const XIRawEvent* event = (const XIRawEvent*)cookie->data;
 
-    frameCounter++;
-    Uint32 currentTime = SDL_GetTicks();
+        auto it = slaveMasters.find(event->deviceid);
+        int master = (it != slaveMasters.end()) ? it->second : event->deviceid;
 
-    // Track mouse movement for sleep detection
-    if (mouse_x != lastMouseX || mouse_y != lastMouseY) {
-        // Mouse has moved
-        lastMouseX = mouse_x;
-        lastMouseY = mouse_y;
-        lastMouseMoveTime = currentTime;
-
-        // Wake up if sleeping and mouse moves
-        if (state == SLEEPING) {
-            state = WAKING_UP;
-            tiredCounter = 1;
-        } else if (state == FALLING_ASLEEP) {
-            // Cancel falling asleep if mouse moves
-            state = IDLE;
-            inIdleBuffer = true;
-            idleBufferStartTime = currentTime;
+        for (CatInstance* cat : cats) {
+            if (cat->deviceId == master) {
+                cat->motionPending = true;
+            }
         }
     }
+}
 
-    // Track state changes and initialize timing
-    if (state != lastState) {
-        stateStartTime = currentTime;
-        lastState = state;
+void DesktopCat::queryPointer(int deviceId, int* mouseX, int* mouseY) {
+    if (deviceId == CORE_POINTER) {
+        SDL_GetGlobalMouseState(mouseX, mouseY);
+        return;
     }
 
-    // Track mouse distance for future use
-    lastMouseDistance = distance;
+    Window root, child;
+    double rootX, rootY, winX, winY;
+    XIButtonState buttons;
+    XIModifierState mods;
+    XIGroupState group;
 
-    // State machine logic with chase mode and deadzone
-    if (inChaseMode) {
-        // CHASE MODE: Deadzone disabled, chase until inner radius (50px)
-        if (distance > ALERT_DEADZONE_INNER) {
-            // Still chasing
-            state = RUNNING;
-            idleCounter = 0;
-            tiredCounter = 0;
+    if (XIQueryPointer(x11EventDisplay, deviceId, DefaultRootWindow(x11EventDisplay),
+                       &root, &child, &rootX, &rootY, &winX, &winY, &buttons, &mods, &group)) {
+        *mouseX = (int)rootX;
+        *mouseY = (int)rootY;
+        XFree(buttons.mask);
+    }
+}
 
-            direction = calculateDirection(dx, dy);
+void DesktopCat::samplePointer(CatInstance* cat, bool force) {
+    // With raw motion events a pointer that hasn't moved costs no request
+    if (!force && cat->deviceId != CORE_POINTER && xiRawMotion && !cat->motionPending) {
+        return;
+    }
+    cat->motionPending = false;
 
-            // Move towards mouse
-            double nx = dx / distance;
-            double ny = dy / distance;
+    queryPointer(cat->deviceId, &cat->mouseX, &cat->mouseY);
+}
 
-            x += nx * SPEED;
-            y += ny * SPEED;
+void DesktopCat::pollX11Events() {
+    if (!x11EventDisplay) {
+        return;
+    }
 
-            // Update window position
-            SDL_SetWindowPosition(window, (int)(x - SPRITE_SIZE/2), (int)(y - SPRITE_SIZE/2));
-        } else {
-            // Reached inner radius - stop and re-enable deadzone, show IDLE
-            inChaseMode = false;
-            state = IDLE;
-            inIdleBuffer = true;
-            idleBufferStartTime = currentTime;  // Start idle buffer timer
-            idleCounter = IDLE_ANIMATION_THRESHOLD + 1;
-            tiredCounter = 0;
-        }
-    } else {
-        // IDLE MODE: Deadzone enabled
-        if (distance > ALERT_DEADZONE_OUTER) {
-            // Mouse far away - start chasing (disable deadzone)
-            inChaseMode = true;
-            state = RUNNING;
-            idleCounter = 0;
-            tiredCounter = 0;
-        } else if (distance > ALERT_DEADZONE_INNER) {
-            // In deadzone - show alert (no movement)
-            state = ALERT;
-            idleCounter = 0;
-            tiredCounter = 0;
-            inIdleBuffer = false;
-        } else {
-            // Inside cat zone - random animations
-            idleCounter++;
-
-            if (state == RUNNING || state == ALERT) {
-                // Just arrived at cat zone - show IDLE frame, then wait before animation
-                state = IDLE;
-                inIdleBuffer = true;
-                idleBufferStartTime = currentTime;  // Start idle buffer timer
-                idleCounter = IDLE_ANIMATION_THRESHOLD + 1;  // Skip initial wait
-                tiredCounter = 0;
-            } else if (idleCounter > IDLE_ANIMATION_THRESHOLD) {
-            // Been idle for a while, check for sleep or animation changes
-
-            // Check if mouse has been idle long enough to trigger sleep
-            Uint32 mouseIdleTime = currentTime - lastMouseMoveTime;
-            if (mouseIdleTime >= MOUSE_IDLE_SLEEP_TIME_MS && state != SLEEPING && state != FALLING_ASLEEP && state != WAKING_UP) {
-                // Mouse idle for too long, go to sleep
-                state = FALLING_ASLEEP;
-                lastAnimationType = SLEEPING;
-                tiredCounter = 1;
-            } else if (state == FALLING_ASLEEP) {
-                tiredCounter++;
-                if (tiredCounter > TIRED_DELAY) {
-                    state = SLEEPING;
-                    tiredCounter = 0;
-                }
-            } else if (state == SLEEPING) {
-                // Sleep continues until mouse moves (handled above in mouse movement detection)
-                // Just keep sleeping...
-            } else if (state == WAKING_UP) {
-                tiredCounter++;
-                if (tiredCounter > TIRED_DELAY) {
-                    state = IDLE;
-                    inIdleBuffer = true;
-                    idleBufferStartTime = currentTime;
-                    lastAnimationType = SLEEPING;  // Mark that we just woke from sleep
-                    tiredCounter = 0;
-                }
-            } else if (state == IDLE && inIdleBuffer) {
-                // In idle buffer, wait before picking next animation
-                Uint32 timeInBuffer = currentTime - idleBufferStartTime;
-                if (timeInBuffer >= IDLE_BUFFER_TIME_MS) {
-                    // Build list of available animations (excluding last played)
-                    // Note: Sleep is NOT in random selection - triggered by mouse idle instead
-                    CatState availableAnims[4];
-                    int availableCount = 0;
-
-                    if (lastAnimationType != IDLE) availableAnims[availableCount++] = IDLE;
-                    if (lastAnimationType != SCRATCHING) availableAnims[availableCount++] = SCRATCHING;
-                    if (lastAnimationType != ITCHING) availableAnims[availableCount++] = ITCHING;
-                    if (lastAnimationType != PAWUP) availableAnims[availableCount++] = PAWUP;
-
-                    // Pick random animation from available
-                    CatState nextAnim = availableAnims[rand() % availableCount];
-                    state = nextAnim;
-                    lastAnimationType = nextAnim;
-
-                    if (nextAnim == SCRATCHING) {
-                        // Pick random direction for scratching
-                        int randomDir = rand() % 4;
-                        direction = (randomDir == 0) ? NORTH : (randomDir == 1) ? EAST : (randomDir == 2) ? SOUTH : WEST;
-                    }
-                    inIdleBuffer = false;
-                }
-            } else {
-                // Playing an animation, check if should return to idle buffer
-                // Exception: SLEEPING state has its own wake-up logic, don't apply min/max time
-                if (state != SLEEPING) {
-                    Uint32 timeInState = currentTime - stateStartTime;
-                    bool shouldSwitch = false;
-
-                    if (timeInState >= ANIM_PLAY_TIME_MAX_MS) {
-                        shouldSwitch = true;  // Force switch after max time
-                    } else if (timeInState >= ANIM_PLAY_TIME_MIN_MS) {
-                        // After min time, random chance to switch (10% per frame)
-                        if ((rand() % 100) < 10) {
-                            shouldSwitch = true;
-                        }
-                    }
+    // Drain only what already arrived; never blocks or round-trips
+    while (XPending(x11EventDisplay)) {
+        XEvent event;
+        XNextEvent(x11EventDisplay, &event);
 
-                    if (shouldSwitch) {
-                        // Return to idle buffer
-                        state = IDLE;
-                        inIdleBuffer = true;
-                        idleBufferStartTime = currentTime;
-                    }
-                }
+        if (event.type == GenericEvent && event.xcookie.extension == xiOpcode) {
+            if (XGetEventData(x11EventDisplay, &event.xcookie)) {
+                handleXInputEvent(&event.xcookie);
+                XFreeEventData(x11EventDisplay, &event.xcookie);
             }
+            continue;
         }
+
+        if (!powerWatch.handleEvent(event)) {
+            windowIndex.handleEvent(event);
+            fullscreenWatch.handleEvent(event);
         }
     }
+}
 
-    // Determine animation speed based on state
-    int animSpeed = ANIM_SPEED_IDLE;
-    int maxFrames = 1;
+bool DesktopCat::fullscreenCovering(const CatInstance* cat) const {
+    double x = cat->behavior.getX();
+    double y = cat->behavior.getY();
 
-    switch (state) {
-        case RUNNING:
-            animSpeed = ANIM_SPEED_RUN;
-            maxFrames = 2;
-            break;
-        case SLEEPING:
-            animSpeed = ANIM_SPEED_SLEEP;
-            maxFrames = 2;
-            break;
-        case SCRATCHING:
-            animSpeed = ANIM_SPEED_SCRATCH;
-            maxFrames = 2;  // Scratch has 2 frames per direction
-            break;
-        case ITCHING:
-            animSpeed = ANIM_SPEED_ITCH;
-            maxFrames = 2;  // Itch has 2 frames
-            break;
-        case IDLE:
-        case ALERT:
-        case PAWUP:
-        case FALLING_ASLEEP:
-        case WAKING_UP:
-            animSpeed = 0;  // Single frame, no animation
-            maxFrames = 1;
-            break;
+    // Monitor the cat is on, from SDL's cached display list
+    int numDisplays = SDL_GetNumVideoDisplays();
+    for (int i = 0; i < numDisplays; i++) {
+        SDL_Rect bounds;
+        if (SDL_GetDisplayBounds(i, &bounds) == 0 &&
+            x >= bounds.x && x < bounds.x + bounds.w &&
+            y >= bounds.y && y < bounds.y + bounds.h) {
+            return fullscreenWatch.covers(bounds.x, bounds.y, bounds.w, bounds.h);
+        }
     }
+    return false;
+}
 
-    // Update animation frame based on time
-    if (lastAnimTime == 0) {
-        lastAnimTime = currentTime;
+void DesktopCat::updateFullscreenYield(Uint32 currentTime) {
+    bool changed = false;
+
+    for (CatInstance* cat : cats) {
+        bool covered = fullscreenCovering(cat);
+
+        if (covered && !cat->hidden) {
+            // Unmapped, the cat no longer keeps the compositor from unredirecting the game
+            SDL_Log("Fullscreen window over pointer %d's cat, hiding", cat->deviceId);
+            SDL_HideWindow(cat->window);
+            cat->hidden = true;
+            cat->hiddenSince = currentTime;
+            changed = true;
+        } else if (!covered && cat->hidden) {
+            // Come back where the chase would have taken the cat meanwhile
+            samplePointer(cat, true);
+            cat->behavior.catchUp(cat->mouseX, cat->mouseY, currentTime - cat->hiddenSince);
+            cat->behavior.resume(cat->mouseX, cat->mouseY, currentTime, false);
+
+            cat->windowX = (int)(cat->behavior.getX() - spriteSize/2);
+            cat->windowY = (int)(cat->behavior.getY() - spriteSize/2);
+            SDL_SetWindowPosition(cat->window, cat->windowX, cat->windowY);
+            SDL_ShowWindow(cat->window);
+            cat->hidden = false;
+            cat->lastShape = nullptr;  // Reapply the shape on the next frame
+            cat->drawnFrame = nullptr;
+            changed = true;
+        }
     }
 
-    if (animSpeed > 0 && currentTime - lastAnimTime >= (Uint32)animSpeed) {
-        currentAnimFrame = (currentAnimFrame + 1) % maxFrames;
-        lastAnimTime = currentTime;
+    if (changed && x11Ready) {
+        XFlush(x11Display);
     }
+}
 
-    // Select current frame based on state
-    SpriteFrame currentFrame = IDLE_FRAME;
+bool DesktopCat::suspended() const {
+    if (powerWatch.displayOff()) {
+        return true;
+    }
 
-    switch (state) {
-        case RUNNING: {
-            const SpriteFrame* frames = getCurrentRunFrames();
-            currentFrame = frames[currentAnimFrame];
-            break;
+    // Nothing to draw until a fullscreen window leaves or a pointer appears
+    for (const CatInstance* cat : cats) {
+        if (!cat->hidden) {
+            return false;
         }
-        case ALERT:
-            currentFrame = ALERT_FRAME;
-            break;
-        case IDLE:
-            currentFrame = IDLE_FRAME;
-            break;
-        case SLEEPING:
-            currentFrame = SLEEPING_FRAMES[currentAnimFrame];
-            break;
-        case SCRATCHING: {
-            const SpriteFrame* frames = getCurrentScratchFrames();
-            currentFrame = frames[currentAnimFrame];
-            break;
+    }
+    return true;
+}
+
+void DesktopCat::waitWhileSuspended() {
+    bool fellAsleep = false;
+
+    int x11Fd = x11EventDisplay ? ConnectionNumber(x11EventDisplay) : -1;
+    int signalFd = powerWatch.signalDescriptor();
+
+    // Sleep in select() on our X connection and the lock signals only:
+    // no timers, no pointer polling, no X requests until something changes
+    while (suspended()) {
+        if (powerWatch.displayOff() && !fellAsleep) {
+            SDL_Log("Display off or session locked, suspending");
+            fellAsleep = true;
         }
-        case ITCHING:
-            currentFrame = ITCH_FRAMES[currentAnimFrame];
-            break;
-        case PAWUP:
-            currentFrame = PAWUP_FRAME;
-            break;
-        case FALLING_ASLEEP:
-        case WAKING_UP:
-            currentFrame = TIRED_FRAME;
+
+        fd_set fds;
+        FD_ZERO(&fds);
+        if (x11Fd >= 0) FD_SET(x11Fd, &fds);
+        if (signalFd >= 0) FD_SET(signalFd, &fds);
+
+        if (select(std::max(x11Fd, signalFd) + 1, &fds, NULL, NULL, NULL) < 0 && errno != EINTR) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "select failed while suspended: %s", strerror(errno));
             break;
+        }
+
+        pollX11Events();
+        powerWatch.handleSignals();
+        updateFullscreenYield(SDL_GetTicks());
     }
 
-    drawSprite(currentFrame);
+    SDL_Log("Resuming");
+
+    // Time spent suspended doesn't count; an idle cat is found asleep after the display was off
+    Uint32 currentTime = SDL_GetTicks();
+    for (CatInstance* cat : cats) {
+        samplePointer(cat, true);
+        cat->behavior.resume(cat->mouseX, cat->mouseY, currentTime, fellAsleep);
+    }
 }
 
-DesktopCat::DesktopCat() : window(nullptr), renderer(nullptr), spriteSheet(nullptr), spriteSheetSurface(nullptr),
-                           state(IDLE), lastState(IDLE), lastAnimationType(IDLE),
-                           direction(SOUTH), frameCounter(0), idleCounter(0), tiredCounter(0),
-                           inIdleBuffer(true), inChaseMode(false), running(true),
-                           lastMouseDistance(0.0),
-                           lastMouseX(0), lastMouseY(0), lastMouseMoveTime(0),
-                           lastAnimTime(0), currentAnimFrame(0),
-                           stateStartTime(0), idleBufferStartTime(0),
-                           rightClickCount(0), firstClickTime(0),
-                           leftClickCount(0), firstLeftClickTime(0), currentPaletteIndex(0),
-                           x11Display(nullptr), x11Window(0), x11Ready(false), lastSprite({-1, -1}) {
+void DesktopCat::update() {
+    Uint32 currentTime = SDL_GetTicks();
+    bool coarse = governor.fidelity() >= FIDELITY_COARSE;
 
-    // Seed random number generator for random animations
-    srand(time(NULL));
+    for (CatInstance* cat : cats) {
+        if (cat->hidden) {
+            continue;
+        }
 
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL init failed: %s", SDL_GetError());
-        exit(1);
-    }
+        samplePointer(cat, false);
+        cat->behavior.freezeIdleAnimations(governor.fidelity() >= FIDELITY_FROZEN);
+        cat->behavior.update(cat->mouseX, cat->mouseY, currentTime);
 
-    // Initialize mouse idle timer
-    lastMouseMoveTime = SDL_GetTicks();
+        const FrameDesc& frame = cat->behavior.currentFrame();
+        bool frameChanged = &frame != cat->drawnFrame;
 
-    // Get mouse position to determine which monitor to start on
-    int mouse_x, mouse_y;
-    SDL_GetGlobalMouseState(&mouse_x, &mouse_y);
-    lastMouseX = mouse_x;
-    lastMouseY = mouse_y;
+        // Update window position only when the cat moved a whole pixel
+        int windowX = (int)(cat->behavior.getX() - spriteSize/2);
+        int windowY = (int)(cat->behavior.getY() - spriteSize/2);
+        bool moved = windowX != cat->windowX || windowY != cat->windowY;
 
-    // Find which display contains the mouse
-    int numDisplays = SDL_GetNumVideoDisplays();
-    SDL_Rect displayBounds;
-    bool foundDisplay = false;
+        // Coarse fidelity: small moves wait for a full step or the next frame
+        if (moved && coarse && !frameChanged &&
+            abs(windowX - cat->windowX) < GOVERNOR_MOVE_STEP && abs(windowY - cat->windowY) < GOVERNOR_MOVE_STEP) {
+            governor.count(GOVERNOR_MOVE_DEFERRED);
+            moved = false;
+        }
+        if (moved) {
+            SDL_SetWindowPosition(cat->window, windowX, windowY);
+            cat->windowX = windowX;
+            cat->windowY = windowY;
+        }
 
-    for (int i = 0; i < numDisplays; i++) {
-        if (SDL_GetDisplayBounds(i, &displayBounds) == 0) {
-            if (mouse_x >= displayBounds.x && mouse_x < displayBounds.x + displayBounds.w &&
-                mouse_y >= displayBounds.y && mouse_y < displayBounds.y + displayBounds.h) {
-                // Mouse is on this display, position cat at center of display
-                x = displayBounds.x + displayBounds.w / 2.0;
-                y = displayBounds.y + displayBounds.h / 2.0;
-                foundDisplay = true;
-                break;
-            }
+        // The window keeps its contents; exposes clear drawnFrame
+        if (coarse && !frameChanged) {
+            governor.count(GOVERNOR_REDRAW_SKIPPED);
+            continue;
         }
+        drawSprite(cat, frame);
+        cat->drawnFrame = &frame;
     }
+}
+
+DesktopCat::DesktopCat() : spriteSheetSurface(nullptr), spriteSize(0), kernels(nullptr), mappedSheet(nullptr),
+                           x11Display(nullptr), x11Ready(false), xfixesReady(false),
+                           running(true),
+                           rightClickCount(0), firstClickTime(0),
+                           leftClickCount(0), firstLeftClickTime(0), currentPaletteIndex(0),
+                           x11EventDisplay(nullptr),
+                           xiOpcode(-1), xiRawMotion(false) {
+
+    // Lock signals go through a descriptor; block them before SDL starts threads
+    powerWatch.blockLockSignals();
+
+    // Seed random number generator for random animations
+    srand(time(NULL));
 
-    // Fallback to default position if display detection fails
-    if (!foundDisplay) {
-        x = 400;
-        y = 300;
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL init failed: %s", SDL_GetError());
+        exit(1);
     }
 
     int imgFlags = IMG_INIT_PNG;
@@ -624,108 +708,117 @@ DesktopCat::DesktopCat() : window(nullptr), renderer(nullptr), spriteSheet(nullp
         exit(1);
     }
 
-    // Create window for transparency
-    window = SDL_CreateWindow("Desktop Cat",
-                              SDL_WINDOWPOS_CENTERED,
-                              SDL_WINDOWPOS_CENTERED,
-                              SPRITE_SIZE, SPRITE_SIZE,
-                              SDL_WINDOW_BORDERLESS |
-                              SDL_WINDOW_ALWAYS_ON_TOP |
-                              SDL_WINDOW_SKIP_TASKBAR);
-
-    if (!window) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Window creation failed: %s", SDL_GetError());
-        IMG_Quit();
-        SDL_Quit();
-        exit(1);
+    // Decoded palettes shared with other sessions
+    if (!sheetCache.init()) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "No runtime directory, sprite sheets are decoded per process");
     }
 
-    renderer = SDL_CreateRenderer(window, -1,
-                                  SDL_RENDERER_ACCELERATED |
-                                  SDL_RENDERER_PRESENTVSYNC);
-
-    if (!renderer) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Renderer creation failed: %s", SDL_GetError());
-        SDL_DestroyWindow(window);
-        IMG_Quit();
-        SDL_Quit();
-        exit(1);
-    }
-
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-
     // Load available sprite palettes dynamically
     loadAvailablePalettes();
 
     if (spritePalettes.empty()) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No sprite palettes found");
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
         IMG_Quit();
         SDL_Quit();
         exit(1);
     }
 
-    // Load first palette
+    // Load first palette, decoded once for every cat
     if (!loadSpriteSheet(spritePalettes[0].c_str())) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load sprite sheet: %s", spritePalettes[0].c_str());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
         IMG_Quit();
         SDL_Quit();
         exit(1);
     }
 
-    // Get X11 window handle for transparency (after everything is initialized)
-    SDL_SysWMinfo wmInfo;
-    SDL_VERSION(&wmInfo.version);
-    if (SDL_GetWindowWMInfo(window, &wmInfo)) {
-        x11Display = wmInfo.info.x11.display;
-        x11Window = wmInfo.info.x11.window;
+    // Track top-level windows on our own connection so their events don't go through SDL
+    x11EventDisplay = XOpenDisplay(NULL);
+    if (x11EventDisplay) {
+        eventDisplay = x11EventDisplay;
+        previousErrorHandler = XSetErrorHandler(handleX11Error);
+    }
+    if (x11EventDisplay && windowIndex.init(x11EventDisplay)) {
+        SDL_Log("Tracking %d top-level window(s)", (int)windowIndex.size());
+    } else {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to watch top-level windows, perching disabled");
+    }
 
-        // Ensure X11 window is fully created and sync
-        XSync(x11Display, False);
+    // Suspend while the screen is blanked, powered down or locked
+    if (!x11EventDisplay || !powerWatch.init(x11EventDisplay)) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "MIT-SCREEN-SAVER unavailable, only lock signals suspend the cat");
+    }
 
-        // Mark X11 as ready for transparency operations
-        x11Ready = true;
+    // Get out of the way of fullscreen games and video players
+    if (!x11EventDisplay || !fullscreenWatch.init(x11EventDisplay)) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to watch for fullscreen windows");
+    }
 
-        // Pre-generate all sprite transparency masks
-        generateAllSpriteMasks();
-    } else {
-        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to get X11 window info, transparency disabled: %s", SDL_GetError());
+    // One cat per XI2 master pointer, or a single cat on the core pointer
+    if (!initXInput()) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "XInput2 unavailable, following the core pointer only");
+        spawnCat(CORE_POINTER);
     }
+
+    if (cats.empty()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create any cat window");
+        if (x11EventDisplay) {
+            XCloseDisplay(x11EventDisplay);
+        }
+        SDL_FreeSurface(spriteSheetSurface);
+        delete mappedSheet;
+        IMG_Quit();
+        SDL_Quit();
+        exit(1);
+    }
+
+    // Resolve every frame and pre-generate all sprite transparency shapes
+    buildFrameTable();
 }
 
 DesktopCat::~DesktopCat() {
-    // Free all cached sprite masks
-    if (x11Display) {
-        for (auto& pair : spriteMasks) {
-            XFreePixmap(x11Display, pair.second);
-        }
-        spriteMasks.clear();
+    // Free all cached sprite shapes
+    freeSpriteShapes();
+
+    for (CatInstance* cat : cats) {
+        destroyCat(cat);
+    }
+    cats.clear();
+
+    if (x11EventDisplay) {
+        XCloseDisplay(x11EventDisplay);
     }
 
     SDL_FreeSurface(spriteSheetSurface);
-    SDL_DestroyTexture(spriteSheet);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    delete mappedSheet;
     IMG_Quit();
     SDL_Quit();
 }
 
+// Third-rate ticks must stay under the behavior's tick clamp, or the chase slows down
+static_assert(1000 / FPS * 3 <= (int)MAX_TICK_MS, "FIDELITY_THIRD_RATE ticks exceed MAX_TICK_MS");
+
 void DesktopCat::run() {
     SDL_Event event;
     Uint32 frame_start;
     int frame_time;
-    const int frame_delay = 1000 / FPS;
 
     while (running) {
         frame_start = SDL_GetTicks();
+        int frame_delay = 1000 / FPS * governor.tickDivisor();
+        counters.mark(PHASE_EVENTS);
+        counters.countFrame();
 
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
             }
+            if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                for (CatInstance* cat : cats) {
+                    if (SDL_GetWindowID(cat->window) == event.window.windowID) {
+                        cat->drawnFrame = nullptr;
+                    }
+                }
+            }
             if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
                 running = false;
             }
@@ -768,11 +861,28 @@ void DesktopCat::run() {
             }
         }
 
+        pollX11Events();
+        powerWatch.handleSignals();
+        updateFullscreenYield(SDL_GetTicks());
+
+        if (suspended()) {
+            counters.mark(PHASE_SLEEP);
+            waitWhileSuspended();
+            governor.reset(SDL_GetTicks());  // Suspended time would read as headroom
+            continue;
+        }
+
+        counters.mark(PHASE_UPDATE);
         update();
 
+        counters.mark(PHASE_SLEEP);
+        governor.sample(SDL_GetTicks());
         frame_time = SDL_GetTicks() - frame_start;
         if (frame_delay > frame_time) {
             SDL_Delay(frame_delay - frame_time);
         }
     }
+
+    counters.report();
+    governor.report();
 }
@@ -0,0 +1,24 @@
+#include "include/frame_table.h"
+
+void fillFrameTable(FrameDesc* table, int cellSize) {
+    // One entry per (state, direction, frame). Slots past an animation's frame
+    // count repeat its first frame so any frame index stays valid.
+    for (int s = 0; s < CAT_STATE_COUNT; s++) {
+        const AnimationDef& anim = ANIMATIONS[s];
+
+        for (int d = 0; d < DIRECTION_COUNT; d++) {
+            for (int f = 0; f < MAX_ANIM_FRAMES; f++) {
+                const SpriteFrame& cell = anim.frame(d, f < anim.frameCount ? f : 0);
+                FrameDesc& entry = table[frameIndex((CatState)s, (Direction)d, f)];
+
+                entry.src.x = cell.x * cellSize;
+                entry.src.y = cell.y * cellSize;
+                entry.src.w = cellSize;
+                entry.src.h = cellSize;
+                entry.durationMs = anim.frameDurationMs;
+                entry.frameCount = anim.frameCount;
+                entry.shape = nullptr;
+            }
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#include "include/fullscreen_watch.h"
+#include <X11/Xatom.h>
+
+FullscreenWatch::FullscreenWatch() : display(nullptr), root(0), netActiveWindow(None), netWmState(None),
+                                     netWmStateFullscreen(None), active(None), fullscreen(false),
+                                     rect({0, 0, 0, 0}) {
+}
+
+bool FullscreenWatch::init(Display* dpy) {
+    display = dpy;
+    root = DefaultRootWindow(display);
+
+    netActiveWindow = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+    netWmState = XInternAtom(display, "_NET_WM_STATE", False);
+    netWmStateFullscreen = XInternAtom(display, "_NET_WM_STATE_FULLSCREEN", False);
+
+    // Keep whatever else this connection already selects on the root window
+    XWindowAttributes attrs;
+    if (!XGetWindowAttributes(display, root, &attrs)) {
+        return false;
+    }
+    XSelectInput(display, root, attrs.your_event_mask | PropertyChangeMask);
+
+    setActive(readActiveWindow());
+    return true;
+}
+
+Window FullscreenWatch::readActiveWindow() {
+    Atom type;
+    int format;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+    Window w = None;
+
+    if (XGetWindowProperty(display, root, netActiveWindow, 0, 1, False, XA_WINDOW,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        if (format == 32 && count == 1) {
+            w = (Window)*(unsigned long*)data;  // Format 32 properties come back as longs
+        }
+        XFree(data);
+    }
+    return w;
+}
+
+void FullscreenWatch::setActive(Window w) {
+    if (w == active) {
+        return;
+    }
+
+    if (active) {
+        XSelectInput(display, active, NoEventMask);
+    }
+
+    active = w;
+    fullscreen = false;
+
+    if (active) {
+        XSelectInput(display, active, PropertyChangeMask | StructureNotifyMask);
+        refreshState();
+    }
+}
+
+void FullscreenWatch::refreshState() {
+    Atom type;
+    int format;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+
+    fullscreen = false;
+    if (XGetWindowProperty(display, active, netWmState, 0, 64, False, XA_ATOM,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        const unsigned long* atoms = (const unsigned long*)data;
+        for (unsigned long i = 0; format == 32 && i < count; i++) {
+            if (atoms[i] == netWmStateFullscreen) {
+                fullscreen = true;
+                break;
+            }
+        }
+        XFree(data);
+    }
+
+    if (fullscreen) {
+        refreshGeometry();
+    }
+}
+
+void FullscreenWatch::refreshGeometry() {
+    XWindowAttributes attrs;
+    Window child;
+    int rootX, rootY;
+
+    if (!XGetWindowAttributes(display, active, &attrs) ||
+        !XTranslateCoordinates(display, active, root, 0, 0, &rootX, &rootY, &child)) {
+        fullscreen = false;
+        return;
+    }
+
+    rect.x = rootX;
+    rect.y = rootY;
+    rect.w = attrs.width;
+    rect.h = attrs.height;
+}
+
+void FullscreenWatch::handleEvent(const XEvent& event) {
+    switch (event.type) {
+        case PropertyNotify: {
+            const XPropertyEvent& e = event.xproperty;
+            if (e.window == root && e.atom == netActiveWindow) {
+                setActive(readActiveWindow());
+            } else if (e.window == active && e.atom == netWmState) {
+                refreshState();
+            }
+            break;
+        }
+        case ConfigureNotify:
+            if (fullscreen && event.xconfigure.event == active) {
+                refreshGeometry();
+            }
+            break;
+        case MapNotify:
+            if (event.xmap.event == active) {
+                refreshState();
+            }
+            break;
+        case UnmapNotify:
+            if (event.xunmap.event == active) {
+                fullscreen = false;  // Minimized fullscreen windows cover nothing
+            }
+            break;
+        case DestroyNotify:
+            if (event.xdestroywindow.event == active) {
+                active = None;
+                fullscreen = false;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool FullscreenWatch::covers(int x, int y, int w, int h) const {
+    return fullscreen &&
+           rect.x <= x && rect.y <= y &&
+           rect.x + rect.w >= x + w && rect.y + rect.h >= y + h;
+}
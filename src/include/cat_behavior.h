@@ -0,0 +1,101 @@
+#ifndef CAT_BEHAVIOR_H
+#define CAT_BEHAVIOR_H
+
+#include <SDL2/SDL.h>
+#include "cat_states.h"
+#include "frame_table.h"
+#include "window_index.h"
+#include "cursor_estimator.h"
+
+const int FPS = 15;  // Rendering frame rate
+const double SPEED = 3.0;  // Movement speed in pixels per frame at FPS
+const double CHASE_SPEED = SPEED * FPS;  // Movement speed in pixels per second
+const Uint32 MAX_TICK_MS = 250;  // Longer stalls don't turn into jumps
+const double FOLLOW_DISTANCE = 100.0;  // Radius where cat stops chasing
+const double ALERT_DEADZONE_INNER = 50.0;  // Inner radius for random animations
+const double ALERT_DEADZONE_OUTER = 100.0;  // Outer radius for alert (same as FOLLOW_DISTANCE)
+const Uint32 IDLE_ANIMATION_THRESHOLD_MS = 4000;  // Idle time before sleep or animations start
+const Uint32 TIRED_DELAY_MS = 2000;  // Time to show TIRED_FRAME before state change
+const int MOUSE_IDLE_SLEEP_TIME_MS = 30000;  // Mouse idle time before sleeping (30 seconds)
+
+// Window awareness
+const double PERCH_SNAP_DISTANCE = 32.0;  // Max hop (pixels) onto a nearby window's top edge
+const double OBSTACLE_LOOKAHEAD = 24.0;   // Distance ahead checked for windows while chasing
+
+// Animation play time constraints (in milliseconds)
+const int ANIM_PLAY_TIME_MIN_MS = 3000;   // Minimum time to play an animation (3 seconds)
+const int ANIM_PLAY_TIME_MAX_MS = 10000;  // Maximum time to play an animation (10 seconds)
+const int IDLE_BUFFER_TIME_MS = 10000;    // Time to stay in idle buffer between animations (10 seconds)
+const double ANIM_SWITCH_HALF_LIFE_MS = 440.0;  // Past the minimum, half of all animations end within this
+
+// One cat's state machine and position. Knows nothing about windows or
+// pointer devices: the caller feeds it pointer samples and the time.
+class CatBehavior {
+private:
+    const FrameDesc* frameTable;     // Shared (state, direction, frame) table
+    const WindowIndex* windowIndex;  // Desktop windows to perch on and avoid, may be null
+
+    double x, y;
+    CatState state;
+    CatState lastState;  // Track state changes
+    CatState lastAnimationType;  // Track last animation type to avoid repeats
+    Direction direction;
+    Uint32 idleMs;   // Time spent inside the cat zone
+    Uint32 tiredMs;  // Time spent falling asleep or waking up
+    bool inIdleBuffer;  // True when in idle buffer between animations
+    bool inChaseMode;  // True when chasing (deadzone disabled)
+    double lastMouseDistance;  // Track if mouse is moving away
+
+    // Mouse idle tracking for sleep
+    int lastMouseX, lastMouseY;
+    Uint32 lastMouseMoveTime;
+
+    // Animation timing
+    Uint32 lastAnimTime;
+    int currentAnimFrame;
+    Uint32 stateStartTime;  // Time when current state/animation started (milliseconds)
+    Uint32 idleBufferStartTime;  // Time when idle buffer started (milliseconds)
+    bool idleFrozen;  // Idle animations hold their current frame
+
+    // Perching
+    Window perchWindow;        // Window the cat is sitting on, or None
+    WindowRect perchRect;      // Its geometry when last seen
+
+    // Chase steering, optionally towards the predicted cursor
+    CursorEstimator cursor;
+    bool predictCursor;  // Off by default: it trails the 1 ms path further (bench_path_error)
+    Uint32 lastUpdateTime;
+
+    int spriteSize() const { return frameTable[0].src.w; }  // Cell size of the loaded sheet
+    Direction calculateDirection(double dx, double dy);
+    void steerAroundWindows(double* nx, double* ny, double goalX, double goalY);
+    void tryPerch(double mouseX, double mouseY);
+    void followPerch();
+
+public:
+    CatBehavior(const FrameDesc* frameTable, const WindowIndex* windowIndex,
+                double startX, double startY, int mouseX, int mouseY, Uint32 now);
+
+    void update(int mouseX, int mouseY, Uint32 now);
+
+    // Advance the chase by the ground it would have covered in elapsedMs
+    void catchUp(int mouseX, int mouseY, Uint32 elapsedMs);
+
+    // Rebase timers after a suspension; fellAsleep puts an idle cat to sleep
+    void resume(int mouseX, int mouseY, Uint32 now, bool fellAsleep);
+
+    // Hold idle, sleeping and grooming animations on one frame (CPU governor)
+    void freezeIdleAnimations(bool frozen) { idleFrozen = frozen; }
+
+    // Steer the chase at the predicted cursor instead of the last sample (default)
+    void setPrediction(bool enabled) { predictCursor = enabled; }
+
+    double getX() const { return x; }
+    double getY() const { return y; }
+    CatState getState() const { return state; }
+    const FrameDesc& currentFrame() const {
+        return frameTable[frameIndex(state, direction, currentAnimFrame)];
+    }
+};
+
+#endif // CAT_BEHAVIOR_H
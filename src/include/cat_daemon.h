@@ -0,0 +1,96 @@
+#ifndef CAT_DAEMON_H
+#define CAT_DAEMON_H
+
+#include <SDL2/SDL.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+#include <string>
+#include <vector>
+#include "frame_table.h"
+#include "sprite_kernels.h"
+#include "sheet_cache.h"
+#include "cat_behavior.h"
+#include "window_index.h"
+#include "power_watch.h"
+
+// Daemon mode
+const char* const DAEMON_SOCKET_NAME = "mousecat-daemon.sock";  // Control socket in $XDG_RUNTIME_DIR
+const size_t DAEMON_MAX_COMMAND = 256;  // Longest control command accepted
+
+// One X display served by the daemon: its connection, the cat window and the
+// server-side copy of the shared sprite sheet
+struct DaemonDisplay {
+    std::string name;
+    Display* display;
+    bool lost;                               // Connection died, detached on the next pass
+    Window window;
+    Pixmap sheet;                            // Sprite sheet uploaded once to this server
+    GC gc;
+    bool xfixes;
+    std::vector<XserverRegion> cellRegions;  // Per sheet cell, empty without XFixes
+    WindowIndex windowIndex;
+    PowerWatch powerWatch;
+    bool suspended;                          // Screen saver or DPMS off on this display
+    int xiOpcode;                            // XInputExtension, -1 without XI 2.1 raw motion
+    bool pointerMoved;                       // Raw motion since the last pointer query
+    int mouseX, mouseY;
+    int windowX, windowY;
+    int shownCell;                           // Sheet cell on screen, -1 forces a redraw
+    CatBehavior behavior;
+
+    DaemonDisplay(const std::string& name, Display* display, const FrameDesc* frameTable,
+                  double startX, double startY, int mouseX, int mouseY, Uint32 now);
+};
+
+// A control socket connection and the command read from it so far
+struct ControlClient {
+    int fd;
+    std::string input;
+};
+
+// Serves one cat per X display from a single process with raw Xlib windows.
+// Every connection, the control socket and its clients share one select();
+// the sprite sheet is decoded and its shapes packed once for all displays.
+// Displays are attached and detached at runtime through the control socket.
+class CatDaemon {
+private:
+    SheetCache sheetCache;
+    SDL_Surface* spriteSheetSurface;
+    MappedSheet* mappedSheet;
+    int spriteSize;
+    int sheetColumns, sheetRows;
+    FrameDesc frameTable[FRAME_TABLE_SIZE];
+    std::vector<std::vector<XRectangle>> cellRects;  // Packed once, sent to every display
+
+    std::vector<DaemonDisplay*> displays;
+    int controlFd;  // -1 without a runtime directory
+    std::string controlPath;
+    std::vector<ControlClient> clients;
+
+    bool loadSheet(const char* path);
+    bool openControlSocket();
+    bool uploadSheet(DaemonDisplay* d);
+    void destroyDisplay(DaemonDisplay* d);
+    DaemonDisplay* findDisplay(const std::string& name) const;
+    void pollDisplay(DaemonDisplay* d);
+    void updateDisplay(DaemonDisplay* d, Uint32 currentTime);
+    void drawCell(DaemonDisplay* d, int cell);
+    void acceptClient();
+    bool serviceClient(ControlClient* client);
+    std::string handleCommand(const std::string& command);
+
+public:
+    CatDaemon();
+    ~CatDaemon();
+
+    bool init(const char* sheetPath);
+    bool attach(const std::string& name, std::string* reply);
+    bool detach(const std::string& name, std::string* reply);
+    // Serves until quit or a signal; false when there is nothing left to serve
+    bool run();
+
+    // Client side of the control socket: sends one command and prints the reply
+    static bool sendCommand(const std::string& command);
+};
+
+#endif // CAT_DAEMON_H
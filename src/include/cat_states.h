@@ -13,6 +13,8 @@ enum CatState {
     WAKING_UP
 };
 
+const int CAT_STATE_COUNT = WAKING_UP + 1;
+
 enum Direction {
     NORTH,
     NORTHEAST,
@@ -24,4 +26,6 @@ enum Direction {
     NORTHWEST
 };
 
+const int DIRECTION_COUNT = NORTHWEST + 1;
+
 #endif // CAT_STATES_H
@@ -0,0 +1,90 @@
+#ifndef CPU_GOVERNOR_H
+#define CPU_GOVERNOR_H
+
+#include <SDL2/SDL.h>
+#include <string>
+
+// CPU budget governor
+const double CPU_BUDGET_BATTERY_SCALE = 0.5;  // Share of the budget kept while on battery
+const double CPU_BUDGET_HEADROOM = 0.5;       // Step fidelity back up below this share of the budget
+const Uint32 GOVERNOR_SAMPLE_MS = 1000;       // CPU time sampling period
+const int GOVERNOR_WINDOW_SAMPLES = 10;       // Sliding window, in sampling periods
+const int GOVERNOR_MIN_SAMPLES = 3;           // Periods measured before stepping down
+const Uint32 GOVERNOR_POWER_POLL_MS = 30000;  // How often the AC state is re-read
+const int GOVERNOR_MOVE_STEP = 4;             // Smallest window move at coarse fidelity (pixels)
+const char* const POWER_SUPPLY_ONLINE_PATH = "/sys/class/power_supply/AC/online";  // "1" on AC, "0" on battery
+
+// Fidelity levels; each one keeps the savings of those before it
+enum Fidelity {
+    FIDELITY_FULL,
+    FIDELITY_COARSE,      // Redraw only when the frame changes, move in GOVERNOR_MOVE_STEP steps
+    FIDELITY_FROZEN,      // Idle animations hold a single frame
+    FIDELITY_HALF_RATE,   // Tick at FPS / 2
+    FIDELITY_THIRD_RATE,  // Tick at FPS / 3
+    FIDELITY_COUNT
+};
+
+// Governor decisions, reported at exit
+enum GovernorCounter {
+    GOVERNOR_STEP_DOWN,      // Over budget, fidelity lowered
+    GOVERNOR_STEP_UP,        // Headroom returned, fidelity raised
+    GOVERNOR_ON_BATTERY,     // Budget tightened
+    GOVERNOR_ON_AC,          // Budget restored
+    GOVERNOR_REDRAW_SKIPPED, // Tick that left a cat's window untouched
+    GOVERNOR_MOVE_DEFERRED,  // Sub-step window move held back
+    GOVERNOR_COUNTER_COUNT
+};
+
+// Keeps the process under a share of one core. CPU time is sampled once per
+// GOVERNOR_SAMPLE_MS and averaged over a sliding window; over budget the
+// fidelity drops one level, well under it the fidelity comes back. Stepping
+// down needs a few periods, stepping up a full window, so it doesn't flap.
+class CpuGovernor {
+private:
+    double budget;          // Share of one core, 0 when off
+    std::string powerPath;  // Sysfs AC "online" file
+    bool onBattery;
+    Uint32 nextPowerPoll;
+    Fidelity level;
+
+    // Ring of (wall clock, CPU time) samples since the last level change
+    Uint32 sampleWall[GOVERNOR_WINDOW_SAMPLES + 1];
+    Uint64 sampleCpu[GOVERNOR_WINDOW_SAMPLES + 1];
+    int sampleCount;
+    int sampleHead;  // Slot of the newest sample
+    Uint32 nextSample;
+    double lastUsage;  // Share of one core over the window at the last sample
+
+    unsigned long long counters[GOVERNOR_COUNTER_COUNT];
+
+    void takeSample(Uint32 now);
+    void pollPower(Uint32 now);
+    void setLevel(Fidelity next, GovernorCounter reason, double seconds);
+
+public:
+    CpuGovernor();
+
+    // budgetPercent of one core; powerSupplyPath may be null for the default
+    bool enable(double budgetPercent, const char* powerSupplyPath);
+    bool enabled() const { return budget > 0; }
+
+    // Call once per tick; only reads the clock when a period is due
+    void sample(Uint32 now) {
+        if (budget > 0 && (Sint32)(now - nextSample) >= 0) {
+            takeSample(now);
+        }
+    }
+
+    // Restart the window, e.g. after a suspension that used no CPU
+    void reset(Uint32 now);
+
+    Fidelity fidelity() const { return level; }
+    int tickDivisor() const;
+    void count(GovernorCounter counter) { counters[counter]++; }
+    unsigned long long counted(GovernorCounter counter) const { return counters[counter]; }
+
+    // Logs the budget, last usage and every counter
+    void report() const;
+};
+
+#endif // CPU_GOVERNOR_H
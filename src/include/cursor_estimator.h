@@ -0,0 +1,31 @@
+#ifndef CURSOR_ESTIMATOR_H
+#define CURSOR_ESTIMATOR_H
+
+#include <SDL2/SDL.h>
+
+// Alpha-beta filter gains: position trusts the sample, velocity settles over a few ticks
+const double CURSOR_FILTER_ALPHA = 0.85;
+const double CURSOR_FILTER_BETA = 0.45;
+const Uint32 CURSOR_MAX_SAMPLE_GAP_MS = 500;  // Older state is dropped instead of extrapolated
+const Uint32 CURSOR_MAX_LEAD_MS = 150;        // Never predict further ahead than this
+
+// Tracks cursor position and velocity from timestamped samples so the chase
+// can steer towards where the cursor will be rather than where it was.
+class CursorEstimator {
+private:
+    double x, y;    // Filtered position
+    double vx, vy;  // Velocity in pixels per millisecond
+    Uint32 lastTime;
+    bool primed;
+
+public:
+    CursorEstimator();
+
+    void reset(double sampleX, double sampleY, Uint32 now);
+    void addSample(double sampleX, double sampleY, Uint32 now);
+
+    // Estimated position at time `at` (normally the next present)
+    void predict(Uint32 at, double* predictedX, double* predictedY) const;
+};
+
+#endif // CURSOR_ESTIMATOR_H
@@ -6,34 +6,21 @@
 #include <SDL2/SDL_syswm.h>
 #include <X11/Xlib.h>
 #include <X11/extensions/shape.h>
-#include <map>
+#include <X11/extensions/Xfixes.h>
 #include <vector>
 #include <string>
-#include <utility>
+#include <unordered_map>
 #include "cat_states.h"
 #include "sprite_frames.h"
-
-const int SPRITE_SIZE = 32;
-const int FPS = 15;  // Rendering frame rate
-const double SPEED = 3.0;  // Movement speed in pixels per frame
-const double FOLLOW_DISTANCE = 100.0;  // Radius where cat stops chasing
-const double ALERT_DEADZONE_INNER = 50.0;  // Inner radius for random animations
-const double ALERT_DEADZONE_OUTER = 100.0;  // Outer radius for alert (same as FOLLOW_DISTANCE)
-const int IDLE_ANIMATION_THRESHOLD = 60;  // Frames before sleeping
-const int TIRED_DELAY = 30;  // Frames to show TIRED_FRAME before state change
-const int MOUSE_IDLE_SLEEP_TIME_MS = 30000;  // Mouse idle time before sleeping (30 seconds)
-
-// Animation play time constraints (in milliseconds)
-const int ANIM_PLAY_TIME_MIN_MS = 3000;   // Minimum time to play an animation (3 seconds)
-const int ANIM_PLAY_TIME_MAX_MS = 10000;  // Maximum time to play an animation (10 seconds)
-const int IDLE_BUFFER_TIME_MS = 10000;    // Time to stay in idle buffer between animations (10 seconds)
-
-// Animation speeds (milliseconds per frame)
-const int ANIM_SPEED_RUN = 80;      // Running animation speed
-const int ANIM_SPEED_IDLE = 300;     // Idle animation speed
-const int ANIM_SPEED_SLEEP = 500;    // Sleeping animation speed
-const int ANIM_SPEED_SCRATCH = 300;  // Scratching animation speed
-const int ANIM_SPEED_ITCH = 300;     // Itching animation speed
+#include "frame_table.h"
+#include "sprite_kernels.h"
+#include "sheet_cache.h"
+#include "cat_behavior.h"
+#include "window_index.h"
+#include "power_watch.h"
+#include "fullscreen_watch.h"
+#include "phase_counters.h"
+#include "cpu_governor.h"
 
 // Close behavior
 const int CLICKS_TO_CLOSE = 5;       // Number of right clicks required to close
@@ -43,42 +30,51 @@ const int CLICK_WINDOW_MS = 2000;    // Time window for clicks (milliseconds)
 const int CLICKS_TO_SWAP_PALETTE = 3;  // Number of left clicks to swap palette
 const char* const SPRITE_DIR = "src/sprite/";  // Directory containing sprite palettes
 
-class DesktopCat {
-private:
+// Sorted paths of the oneko*.png palettes in SPRITE_DIR
+std::vector<std::string> findSpritePalettes();
+
+const int CORE_POINTER = -1;  // Device id of a cat following SDL's global mouse state
+
+// One cat on screen: its window and the pointer it follows
+struct CatInstance {
+    int deviceId;                  // XI2 master pointer, or CORE_POINTER
     SDL_Window* window;
     SDL_Renderer* renderer;
-    SDL_Texture* spriteSheet;
+    SDL_Texture* spriteSheet;      // Per renderer; the decoded surface is shared
+    Window x11Window;
+    const SpriteShape* lastShape;  // Shape currently applied to the window
+    const FrameDesc* drawnFrame;   // Frame on screen, null forces a redraw
+    int windowX, windowY;          // Last position given to the window
+    int mouseX, mouseY;            // Last pointer sample
+    bool motionPending;            // Raw motion seen since the last sample
+    bool hidden;                   // Unmapped for a fullscreen window
+    Uint32 hiddenSince;
+    CatBehavior behavior;
+
+    CatInstance(int deviceId, const CatBehavior& behavior);
+};
+
+class DesktopCat {
+private:
+    std::vector<CatInstance*> cats;
+
+    // Decoded sprite sheet, shared by every cat
     SDL_Surface* spriteSheetSurface;
+    int spriteSize;                  // Cell size detected from the sheet
+    const SpriteKernels* kernels;    // Pixel loops specialized for spriteSize
+    SheetCache sheetCache;           // Decoded sheets shared between sessions
+    MappedSheet* mappedSheet;        // Cache entry under spriteSheetSurface, or null
 
-    // X11 for transparency
+    // X11 for transparency (SDL's connection, shared by all cat windows)
     Display* x11Display;
-    Window x11Window;
     bool x11Ready;
-    SpriteFrame lastSprite;
-    std::map<std::pair<int, int>, Pixmap> spriteMasks;
-
-    double x, y;
-    CatState state;
-    CatState lastState;  // Track state changes
-    CatState lastAnimationType;  // Track last animation type to avoid repeats
-    Direction direction;
-    int frameCounter;
-    int idleCounter;
-    int tiredCounter;
-    bool inIdleBuffer;  // True when in idle buffer between animations
-    bool inChaseMode;  // True when chasing (deadzone disabled)
-    bool running;
-    double lastMouseDistance;  // Track if mouse is moving away
+    bool xfixesReady;                    // Server supports XFixes window shape regions
+    std::vector<SpriteShape> cellShapes;  // Shapes indexed by sheet cell, empty if unused
 
-    // Mouse idle tracking for sleep
-    int lastMouseX, lastMouseY;
-    Uint32 lastMouseMoveTime;
+    // Flat (state, direction, frame) table built from ANIMATIONS for the loaded sheet
+    FrameDesc frameTable[FRAME_TABLE_SIZE];
 
-    // Animation timing
-    Uint32 lastAnimTime;
-    int currentAnimFrame;
-    Uint32 stateStartTime;  // Time when current state/animation started (milliseconds)
-    Uint32 idleBufferStartTime;  // Time when idle buffer started (milliseconds)
+    bool running;
 
     // Click tracking for close behavior
     int rightClickCount;
@@ -90,21 +86,58 @@ private:
     int currentPaletteIndex;
     std::vector<std::string> spritePalettes;
 
+    // Top-level window tracking for perching and obstacle avoidance
+    Display* x11EventDisplay;  // Separate connection: SDL only reports events for its own window
+    WindowIndex windowIndex;
+
+    // Screen saver, DPMS and session lock state
+    PowerWatch powerWatch;
+
+    // Fullscreen applications the cat yields to
+    FullscreenWatch fullscreenWatch;
+
+    // XInput2 multi-pointer support
+    int xiOpcode;                               // -1 without XI2: a single core-pointer cat
+    bool xiRawMotion;                           // XI 2.1+: sample pointers only after raw motion
+    std::unordered_map<int, int> slaveMasters;  // Slave pointer device -> its master
+
+    // Opt-in per-phase hardware counters (--perf-counters)
+    PhaseCounters counters;
+
+    // Opt-in CPU budget (--cpu-budget)
+    CpuGovernor governor;
+
     void loadAvailablePalettes();
     bool loadSpriteSheet(const char* path);
+    SDL_Texture* createSheetTexture(SDL_Renderer* renderer, SDL_Surface* surface);
     void swapPalette();
-    void drawSprite(const SpriteFrame& sprite);
-    void generateAllSpriteMasks();
-    Pixmap createSpriteMask(const SpriteFrame& sprite);
-    void setX11Transparency(const SpriteFrame& sprite);
-    Direction calculateDirection(double dx, double dy);
-    const SpriteFrame* getCurrentRunFrames();
-    const SpriteFrame* getCurrentScratchFrames();
+    void drawSprite(CatInstance* cat, const FrameDesc& frame);
+    void buildFrameTable();
+    void freeSpriteShapes();
+    void buildSpriteShape(const SpriteFrame& sprite, SpriteShape* shape);
+    void setX11Transparency(CatInstance* cat, const FrameDesc& frame);
+    CatInstance* spawnCat(int deviceId);
+    void destroyCat(CatInstance* cat);
+    void removeCat(int deviceId);
+    bool initXInput();
+    void refreshSlaveMasters();
+    void handleXInputEvent(XGenericEventCookie* cookie);
+    void queryPointer(int deviceId, int* mouseX, int* mouseY);
+    void samplePointer(CatInstance* cat, bool force);
+    void pollX11Events();
+    bool fullscreenCovering(const CatInstance* cat) const;
+    void updateFullscreenYield(Uint32 currentTime);
+    bool suspended() const;
+    void waitWhileSuspended();
     void update();
 
 public:
     DesktopCat();
     ~DesktopCat();
+    bool enableCounters() { return counters.enable(); }
+    bool enableGovernor(double budgetPercent, const char* powerSupplyPath) {
+        return governor.enable(budgetPercent, powerSupplyPath);
+    }
     void run();
 };
 
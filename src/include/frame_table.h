@@ -0,0 +1,35 @@
+#ifndef FRAME_TABLE_H
+#define FRAME_TABLE_H
+
+#include <SDL2/SDL.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xfixes.h>
+#include <vector>
+#include "cat_states.h"
+#include "sprite_frames.h"
+
+// Window shape for one sheet cell, built once per sprite sheet
+struct SpriteShape {
+    std::vector<XRectangle> rects;  // Opaque area as YX-banded rectangles
+    XserverRegion region;           // Server-side region of rects, None without XFixes
+};
+
+// Everything needed to show one frame, resolved once per sprite sheet
+struct FrameDesc {
+    SDL_Rect src;              // Source rect in the sprite sheet
+    const SpriteShape* shape;  // Window shape (shared by entries using the same cell)
+    int durationMs;            // Time per frame, 0 for still frames
+    int frameCount;            // Frames in this (state, direction) animation
+};
+
+const int FRAME_TABLE_SIZE = CAT_STATE_COUNT * DIRECTION_COUNT * MAX_ANIM_FRAMES;
+
+inline int frameIndex(CatState state, Direction direction, int frame) {
+    return ((int)state * DIRECTION_COUNT + (int)direction) * MAX_ANIM_FRAMES + frame;
+}
+
+// Flatten ANIMATIONS into table for a sheet of cellSize cells, without shapes
+void fillFrameTable(FrameDesc* table, int cellSize);
+
+#endif // FRAME_TABLE_H
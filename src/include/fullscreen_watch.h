@@ -0,0 +1,38 @@
+#ifndef FULLSCREEN_WATCH_H
+#define FULLSCREEN_WATCH_H
+
+#include <X11/Xlib.h>
+#include "window_index.h"
+
+// Follows _NET_ACTIVE_WINDOW and the active window's _NET_WM_STATE through
+// PropertyNotify events, so knowing whether a fullscreen window is up never
+// costs a request per tick.
+class FullscreenWatch {
+private:
+    Display* display;
+    Window root;
+    Atom netActiveWindow;
+    Atom netWmState;
+    Atom netWmStateFullscreen;
+    Window active;     // Currently active client window, or None
+    bool fullscreen;   // Active window is mapped and in _NET_WM_STATE_FULLSCREEN
+    WindowRect rect;   // Its geometry in root coordinates while fullscreen
+
+    Window readActiveWindow();
+    void setActive(Window w);
+    void refreshState();
+    void refreshGeometry();
+
+public:
+    FullscreenWatch();
+
+    // Adds PropertyChangeMask to this connection's root window selection
+    bool init(Display* display);
+
+    void handleEvent(const XEvent& event);
+
+    // True if the active fullscreen window covers the given monitor area
+    bool covers(int x, int y, int w, int h) const;
+};
+
+#endif // FULLSCREEN_WATCH_H
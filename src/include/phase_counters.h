@@ -0,0 +1,62 @@
+#ifndef PHASE_COUNTERS_H
+#define PHASE_COUNTERS_H
+
+// Parts of one main loop iteration, in the order they run
+enum Phase {
+    PHASE_EVENTS,   // SDL and X11 event polling, signals, fullscreen checks
+    PHASE_UPDATE,   // Pointer sampling, behavior and window moves
+    PHASE_SHAPE,    // Window shape changes
+    PHASE_PRESENT,  // Clear, copy and present
+    PHASE_SLEEP,    // Frame delay and suspension
+    PHASE_COUNT
+};
+
+enum Counter {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_CONTEXT_SWITCHES,
+    COUNTER_TASK_CLOCK,  // CPU time in nanoseconds
+    COUNTER_COUNT
+};
+
+// Self-monitoring perf_event_open counters for the main thread, charged to
+// whichever loop phase was running. The counters form one group, so each
+// phase change costs a single read(). Counters the CPU or kernel doesn't
+// offer (virtual machines, perf_event_paranoid) are left out; with none at
+// all the instrumentation stays off and every mark() is a no-op.
+class PhaseCounters {
+private:
+    int fds[COUNTER_COUNT];    // -1 for counters that failed to open
+    int slots[COUNTER_COUNT];  // Position in the group read, -1 if not open
+    int groupFd;               // Group leader, -1 when disabled
+    int openCount;
+    Phase current;
+    double last[COUNTER_COUNT];  // Scaled readings at the previous mark
+    double totals[PHASE_COUNT][COUNTER_COUNT];
+    unsigned long long frames;
+
+    bool readGroup(double* values) const;
+    void switchPhase(Phase next);
+
+public:
+    PhaseCounters();
+    ~PhaseCounters();
+
+    // Opens and starts the counters; false if none are available
+    bool enable();
+    bool enabled() const { return groupFd >= 0; }
+
+    // Charge everything since the last mark to the current phase, then enter next
+    void mark(Phase next) {
+        if (groupFd >= 0) {
+            switchPhase(next);
+        }
+    }
+    void countFrame() { frames++; }
+
+    // Logs per-phase totals and per-frame averages
+    void report();
+};
+
+#endif // PHASE_COUNTERS_H
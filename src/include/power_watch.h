@@ -0,0 +1,42 @@
+#ifndef POWER_WATCH_H
+#define POWER_WATCH_H
+
+#include <X11/Xlib.h>
+
+// Tracks whether anyone can see the screen: MIT-SCREEN-SAVER notifications,
+// the DPMS level at each transition, and lock/unlock signals. Without a
+// session bus the lock stand-in is a signal from the screen locker's hook:
+// SIGUSR1 when the session locks, SIGUSR2 when it unlocks.
+class PowerWatch {
+private:
+    Display* display;
+    int saverEventBase;  // -1 without MIT-SCREEN-SAVER
+    bool dpmsReady;
+    bool saverActive;    // Screen saver is on (the server also raises it for DPMS off)
+    bool dpmsOff;        // DPMS level was standby/suspend/off at the last transition
+    bool locked;         // Session lock signalled
+    int signalFd;        // signalfd for the lock signals, -1 if unavailable
+
+    void refreshDpms();
+
+public:
+    PowerWatch();
+    ~PowerWatch();
+
+    // Must run before any thread is spawned so every thread inherits the blocked mask
+    void blockLockSignals();
+
+    // Selects screen saver notifications on the root window of this connection
+    bool init(Display* display);
+
+    // Returns true if the event was a screen saver notification
+    bool handleEvent(const XEvent& event);
+
+    // Consumes pending lock/unlock signals without blocking
+    void handleSignals();
+
+    int signalDescriptor() const { return signalFd; }
+    bool displayOff() const { return saverActive || dpmsOff || locked; }
+};
+
+#endif // POWER_WATCH_H
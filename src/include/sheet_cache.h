@@ -0,0 +1,87 @@
+#ifndef SHEET_CACHE_H
+#define SHEET_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <X11/Xlib.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include "sprite_kernels.h"
+
+// Shared decoded sprite sheets
+const char* const SHEET_CACHE_DIR_ENV = "MOUSECAT_ASSET_DIR";  // Directory shared by several users
+const Uint32 SHEET_CACHE_VERSION = 1;  // Bump when the entry layout changes
+
+// One cache entry mapped read-only: the RGBA32 pixels of a sheet plus the
+// packed shape of each of its cells. Every process using the entry shares
+// the same page cache pages of the pixels; the header and shapes are copied
+// out and checked once, so nothing but pixel values is read from the mapping.
+class MappedSheet {
+private:
+    void* base;
+    size_t size;
+    bool valid;
+    int width, height, pitch, cellSize;
+    size_t pixelsOffset;
+    std::vector<Uint32> cellStarts;     // cellCount + 1 indexes into shapeRects
+    std::vector<XRectangle> shapeRects;  // Every cell's shape, inside its cell
+
+public:
+    MappedSheet();
+    ~MappedSheet();
+
+    // Takes a mapping of a complete entry; false if it isn't a valid one
+    bool attach(void* mapping, size_t length);
+
+    int frameSize() const;
+
+    // Surface over the mapped pixels, no copy; must not outlive this mapping
+    SDL_Surface* createSurface() const;
+
+    // Shape of the cell at (column, row) in sheet cells
+    bool cellShape(int column, int row, std::vector<XRectangle>* rects) const;
+
+    // Bytes needed for an entry of this sheet and its shapes
+    static size_t entrySize(int width, int height, int cellCount, size_t rectCount);
+
+    // Lay out an entry in dst (entrySize() bytes)
+    static void writeEntry(Uint8* dst, const SDL_Surface* rgba, int frameSize,
+                           const std::vector<std::vector<XRectangle>>& shapes);
+};
+
+// Decoded sheets keyed by the PNG's path, size and modification time, stored
+// as read-only files on a tmpfs: $XDG_RUNTIME_DIR for one user, or
+// $MOUSECAT_ASSET_DIR for every session on the host. The first process
+// decodes and publishes an entry with an atomic rename; later ones only map it.
+// Entry names carry the publisher's uid and only our own or root's entries
+// are mapped, so in a shared directory each user keeps one copy per sheet
+// unless root published it first.
+class SheetCache {
+private:
+    std::string directory;  // Empty when caching is off
+    bool shared;            // Entries readable by other users
+
+    bool entryPath(const char* sheetPath, uid_t owner, std::string* path) const;
+    MappedSheet* openEntry(const std::string& path, uid_t owner) const;
+    void removeStaleEntries() const;
+
+public:
+    SheetCache();
+
+    // Picks the cache directory and drops our entries of older layouts; false if there is none
+    bool init();
+    bool enabled() const { return !directory.empty(); }
+
+    // Maps the entry for sheetPath, null on a miss
+    MappedSheet* open(const char* sheetPath) const;
+
+    // Publishes a freshly decoded RGBA32 sheet with its cell shapes and maps it
+    MappedSheet* store(const char* sheetPath, const SDL_Surface* rgba, const SpriteKernels* kernels) const;
+
+    // RGBA32 sheet of a supported frame size, mapped from the cache or decoded
+    // and published. *mapped receives the entry under the surface, or null;
+    // free the surface before deleting it.
+    SDL_Surface* load(const char* sheetPath, MappedSheet** mapped) const;
+};
+
+#endif // SHEET_CACHE_H
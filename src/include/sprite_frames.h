@@ -1,44 +1,101 @@
 #ifndef SPRITE_FRAMES_H
 #define SPRITE_FRAMES_H
 
+#include <cstddef>
+#include "cat_states.h"
+
 struct SpriteFrame {
     int x, y;
 };
 
-// Sprite positions in the sheet (x, y in grid coordinates)
-// Coordinates converted from oneko.js CSS positions (negative values → absolute)
-namespace SpriteFrames {
-    // Idle and alert animations
-    const SpriteFrame IDLE_FRAME = {3, 3};                 // idle animation (single frame)
-    const SpriteFrame ALERT_FRAME = {7, 3};                // alert state
-    const SpriteFrame TIRED_FRAME = {3, 2};                // tired state
-
-    // Sleeping animation (2 frames)
-    const SpriteFrame SLEEPING_FRAMES[2] = {{2, 0}, {2, 1}};
-
-    // Itch animations (2 frames)
-    const SpriteFrame ITCH_FRAMES[2] = {{5, 0}, {6, 0}};
-
-    // Paw up frame (single frame)
-    const SpriteFrame PAWUP_FRAME = {7, 0};
-
-    // Scratch animations (2 frames per direction, 4 directions)
-    const SpriteFrame SCRATCH_NORTH[2] = {{4, 0}, {4, 1}};
-    const SpriteFrame SCRATCH_EAST[2] = {{0, 0}, {0, 1}};
-    const SpriteFrame SCRATCH_SOUTH[2] = {{6, 2}, {7, 1}};
-    const SpriteFrame SCRATCH_WEST[2] = {{2, 2}, {2, 3}};
-
-    // Running animations for 8 directions (2 frames each)
-    const SpriteFrame RUN_NORTH[2] = {{1, 2}, {1, 3}};      // N
-    const SpriteFrame RUN_NORTHEAST[2] = {{0, 2}, {0, 3}};  // NE
-    const SpriteFrame RUN_EAST[2] = {{3, 0}, {3, 1}};       // E
-    const SpriteFrame RUN_SOUTHEAST[2] = {{5, 1}, {5, 2}};  // SE
-    const SpriteFrame RUN_SOUTH[2] = {{6, 3}, {7, 2}};      // S
-    const SpriteFrame RUN_SOUTHWEST[2] = {{5, 3}, {6, 1}};  // SW
-    const SpriteFrame RUN_WEST[2] = {{4, 2}, {4, 3}};       // W
-    const SpriteFrame RUN_NORTHWEST[2] = {{1, 0}, {1, 1}};  // NW
+// Animation speeds (milliseconds per frame)
+const int ANIM_SPEED_RUN = 80;      // Running animation speed
+const int ANIM_SPEED_IDLE = 300;     // Idle animation speed
+const int ANIM_SPEED_SLEEP = 500;    // Sleeping animation speed
+const int ANIM_SPEED_SCRATCH = 300;  // Scratching animation speed
+const int ANIM_SPEED_ITCH = 300;     // Itching animation speed
+
+// One animation: the sheet cells for every direction, plus its timing
+struct AnimationDef {
+    CatState state;          // Checked against the entry's position in ANIMATIONS
+    int frameCount;          // Frames per direction
+    int frameDurationMs;     // 0 for still frames
+    const SpriteFrame* frames;
+    int directionStride;     // Cells between directions, 0 when all share one row
+
+    constexpr const SpriteFrame& frame(int direction, int f) const {
+        return frames[direction * directionStride + f];
+    }
+};
+
+// An animation with its own row of frames per direction
+template <size_t Directions, size_t Frames>
+constexpr AnimationDef directional(CatState state, int durationMs,
+                                   const SpriteFrame (&frames)[Directions][Frames]) {
+    static_assert(Directions == DIRECTION_COUNT, "one row of frames per direction");
+    return AnimationDef{state, (int)Frames, durationMs, &frames[0][0], (int)Frames};
 }
 
-#endif // SPRITE_FRAMES_H
+// An animation that looks the same in every direction
+template <size_t Frames>
+constexpr AnimationDef allDirections(CatState state, int durationMs, const SpriteFrame (&frames)[Frames]) {
+    return AnimationDef{state, (int)Frames, durationMs, frames, 0};
+}
+
+// Sprite positions in the sheet (x, y in grid coordinates). Coordinates converted
+// from oneko.js CSS positions (negative values → absolute). Sheets with more
+// frames or distinct directions only need their rows edited here.
+constexpr SpriteFrame IDLE_FRAMES[] = {{3, 3}};
+constexpr SpriteFrame ALERT_FRAMES[] = {{7, 3}};
+constexpr SpriteFrame RUNNING_FRAMES[][2] = {
+    {{1, 2}, {1, 3}},  // N
+    {{0, 2}, {0, 3}},  // NE
+    {{3, 0}, {3, 1}},  // E
+    {{5, 1}, {5, 2}},  // SE
+    {{6, 3}, {7, 2}},  // S
+    {{5, 3}, {6, 1}},  // SW
+    {{4, 2}, {4, 3}},  // W
+    {{1, 0}, {1, 1}}   // NW
+};
+constexpr SpriteFrame SLEEPING_FRAMES[] = {{2, 0}, {2, 1}};
+constexpr SpriteFrame SCRATCHING_FRAMES[][2] = {  // Sheet only has N, E, S and W
+    {{4, 0}, {4, 1}},  // N
+    {{4, 0}, {4, 1}},  // NE -> N
+    {{0, 0}, {0, 1}},  // E
+    {{0, 0}, {0, 1}},  // SE -> E
+    {{6, 2}, {7, 1}},  // S
+    {{2, 2}, {2, 3}},  // SW -> W
+    {{2, 2}, {2, 3}},  // W
+    {{4, 0}, {4, 1}}   // NW -> N
+};
+constexpr SpriteFrame ITCHING_FRAMES[] = {{5, 0}, {6, 0}};
+constexpr SpriteFrame PAWUP_FRAMES[] = {{7, 0}};
+constexpr SpriteFrame TIRED_FRAMES[] = {{3, 2}};  // FALLING_ASLEEP and WAKING_UP
 
+constexpr AnimationDef ANIMATIONS[] = {
+    allDirections(IDLE, 0, IDLE_FRAMES),
+    allDirections(ALERT, 0, ALERT_FRAMES),
+    directional(RUNNING, ANIM_SPEED_RUN, RUNNING_FRAMES),
+    allDirections(SLEEPING, ANIM_SPEED_SLEEP, SLEEPING_FRAMES),
+    directional(SCRATCHING, ANIM_SPEED_SCRATCH, SCRATCHING_FRAMES),
+    allDirections(ITCHING, ANIM_SPEED_ITCH, ITCHING_FRAMES),
+    allDirections(PAWUP, 0, PAWUP_FRAMES),
+    allDirections(FALLING_ASLEEP, 0, TIRED_FRAMES),
+    allDirections(WAKING_UP, 0, TIRED_FRAMES)
+};
 
+constexpr bool animationsInStateOrder(int i) {
+    return i == CAT_STATE_COUNT || (ANIMATIONS[i].state == i && animationsInStateOrder(i + 1));
+}
+
+constexpr int maxFrameCount(int i) {
+    return i == CAT_STATE_COUNT ? 0 :
+           ANIMATIONS[i].frameCount > maxFrameCount(i + 1) ? ANIMATIONS[i].frameCount : maxFrameCount(i + 1);
+}
+
+static_assert(sizeof(ANIMATIONS) / sizeof(ANIMATIONS[0]) == CAT_STATE_COUNT, "one animation per CatState");
+static_assert(animationsInStateOrder(0), "ANIMATIONS must be listed in CatState order");
+
+const int MAX_ANIM_FRAMES = maxFrameCount(0);  // Longest animation, sizes the frame table
+
+#endif // SPRITE_FRAMES_H
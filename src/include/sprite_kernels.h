@@ -0,0 +1,31 @@
+#ifndef SPRITE_KERNELS_H
+#define SPRITE_KERNELS_H
+
+#include <SDL2/SDL.h>
+#include <X11/Xlib.h>
+#include <vector>
+
+// Sheet layout shared by every palette; only the cell size varies
+const int SHEET_COLUMNS = 8;
+const int SHEET_ROWS = 4;
+const int SHAPE_ALPHA_THRESHOLD = 128;  // Pixels above this alpha belong to the window shape
+
+// Per-pixel loops over one RGBA32 sheet cell, compiled separately for each
+// supported cell size so their bounds are constants
+struct SpriteKernels {
+    int frameSize;
+
+    // Opaque area of the cell as YX-banded rectangles
+    void (*packShape)(const Uint8* cell, int pitch, std::vector<XRectangle>* rects);
+
+    // Cell blended over opaque RGBA pixels at dst
+    void (*blend)(const Uint8* cell, int pitch, Uint8* dst, int dstPitch);
+};
+
+// Cell size of a sheet from its dimensions, 0 if unsupported
+int detectFrameSize(int sheetWidth, int sheetHeight);
+
+// Kernels for a cell size returned by detectFrameSize(), null otherwise
+const SpriteKernels* spriteKernelsFor(int frameSize);
+
+#endif // SPRITE_KERNELS_H
@@ -0,0 +1,60 @@
+#ifndef TRACE_RENDERER_H
+#define TRACE_RENDERER_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "frame_table.h"
+#include "sprite_kernels.h"
+
+// Offline rendering
+const int TRACE_CANVAS_MARGIN = 128;     // Room around the trace's bounding box (pixels)
+const int TRACE_CURSOR_SIZE = 9;         // Crosshair drawn where the cursor is
+const Uint32 APNG_MAX_DELAY_MS = 65535;  // Longest delay one APNG frame can hold
+const unsigned int RENDER_SEED = 1;      // Default seed so renders are reproducible
+
+// One line of a trace file: "<milliseconds> <x> <y>" in desktop coordinates
+struct TraceSample {
+    Uint32 timeMs;
+    int x, y;
+};
+
+// Replays a cursor trace through CatBehavior on a virtual clock and writes the
+// result as an animated PNG. Needs no X server: nothing is shown on screen.
+class TraceRenderer {
+private:
+    // What one output frame shows, recorded by the simulation
+    struct Snapshot {
+        int catX, catY;        // Sprite's top-left corner on the canvas
+        SDL_Rect src;          // Sheet cell, as drawSprite() copies it
+        int cursorX, cursorY;  // Cursor on the canvas
+        SDL_Rect dirty;        // Canvas area that differs from the previous frame
+        Uint32 durationMs;     // Grows as identical ticks are merged
+    };
+
+    SDL_Surface* spriteSheet;  // RGBA32, byte order R, G, B, A
+    int spriteSize;            // Cell size detected from the sheet
+    const SpriteKernels* kernels;
+    FrameDesc frameTable[FRAME_TABLE_SIZE];
+    std::vector<TraceSample> trace;
+    std::vector<Snapshot> snapshots;
+    int canvasW, canvasH;
+    int originX, originY;  // Desktop position of the canvas' top-left corner
+    Uint32 ticks;          // Behavior updates run
+
+    bool loadTrace(const char* path);
+    bool loadSheet(const char* path);
+    void simulate();
+    void composite(const Snapshot& snap, std::vector<Uint8>* scanlines) const;
+    bool encodeFrames(size_t first, size_t last, std::vector<std::vector<Uint8>>* encoded) const;
+    bool writeApng(const char* path, const std::vector<std::vector<Uint8>>& encoded) const;
+
+public:
+    TraceRenderer();
+    ~TraceRenderer();
+
+    // threads <= 0 uses every core
+    bool render(const char* tracePath, const char* sheetPath, const char* outPath,
+                int threads, unsigned int seed);
+};
+
+#endif // TRACE_RENDERER_H
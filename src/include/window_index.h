@@ -0,0 +1,87 @@
+#ifndef WINDOW_INDEX_H
+#define WINDOW_INDEX_H
+
+#include <X11/Xlib.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstddef>
+
+const int WINDOW_INDEX_CELL_SIZE = 256;  // Default grid cell size in pixels
+const int WINDOW_MIN_WIDTH = 64;         // Narrower windows are not indexed (tooltips, docks, the cat)
+const int WINDOW_MIN_HEIGHT = 32;        // Shorter windows are not indexed
+
+struct WindowRect {
+    int x, y, w, h;
+};
+
+// Spatial index of mapped top-level windows, kept up to date from
+// SubstructureNotify events on the root window instead of querying the
+// window tree every tick. Stacking order is tracked too, so windows buried
+// under others are neither perched on nor dodged.
+class WindowIndex {
+private:
+    struct Entry {
+        WindowRect rect;
+        bool mapped;
+        bool indexed;            // True when the entry is present in the grid
+        int cx0, cy0, cx1, cy1;  // Grid cells covered while indexed
+    };
+
+    int cellSize;  // Grid cell size in pixels
+    Display* display;
+    Window root;
+    std::unordered_map<Window, Entry> windows;
+    std::unordered_map<long long, std::vector<Window> > cells;
+    std::unordered_set<Window> ignored;
+    std::vector<Window> stacking;                // Root children, bottom to top
+    std::unordered_map<Window, int> stackDepth;  // Index into stacking
+
+    static long long cellKey(int cx, int cy);
+    int cellCoord(double v) const;
+    void indexEntry(Window w, Entry& entry);
+    void unindexEntry(Window w, Entry& entry);
+    void addFromAttributes(Window w);
+    void stackOnTop(Window w);
+    void unstack(Window w);
+    void renumberStacking(size_t from);
+    int depthOf(Window w) const { return stackDepth.find(w)->second; }
+    bool coveredAt(Window w, double px, double py) const;
+    bool hiddenBy(Window w, const WindowRect& r, const std::vector<Window>& neighbours) const;
+    bool segmentHitsCell(int cx, int cy, double x0, double y0, double x1, double y1,
+                         double goalX, double goalY) const;
+
+public:
+    explicit WindowIndex(int cellSize = WINDOW_INDEX_CELL_SIZE);
+
+    // Selects SubstructureNotify on the root window and seeds the index once
+    bool init(Display* display);
+
+    // Exclude a window (and any frame it gets reparented into) from the index
+    void ignoreWindow(Window w);
+
+    void handleEvent(const XEvent& event);
+
+    // Direct updates, used by the event handler and for synthetic windows
+    void setWindow(Window w, const WindowRect& rect, bool mapped);
+    void removeWindow(Window w);
+
+    // Stack w directly above sibling `above`, or at the bottom for None
+    void restackWindow(Window w, Window above);
+
+    bool getWindow(Window w, WindowRect* rect) const;
+    size_t size() const { return windows.size(); }
+
+    // Nearest point on the top edge of a mapped window within maxDistance
+    // that no window stacked above it covers
+    bool nearestPerch(double px, double py, double maxDistance,
+                      double* perchX, double* perchY, Window* perchWindow) const;
+
+    // True if the segment crosses a mapped window. Windows containing the
+    // segment start or the goal point, and windows entirely covered by one
+    // stacked above them, are not treated as obstacles.
+    bool segmentIntersects(double x0, double y0, double x1, double y1,
+                           double goalX, double goalY) const;
+};
+
+#endif // WINDOW_INDEX_H
@@ -1,10 +1,150 @@
 #include "include/desktop_cat.h"
+#include "include/trace_renderer.h"
+#include "include/cat_daemon.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+void printUsage(const char* program) {
+    SDL_Log("Usage: %s [--perf-counters] [--cpu-budget PERCENT [--power-supply PATH]]", program);
+    SDL_Log("       %s --render TRACE OUT.png [--sheet SHEET.png] [--threads N] [--seed N]", program);
+    SDL_Log("       %s --daemon [DISPLAY...] [--sheet SHEET.png]", program);
+    SDL_Log("       %s --attach DISPLAY | --detach DISPLAY", program);
+}
+
+// Explicit sheet, or the first palette found
+bool pickSheet(const char* sheetPath, std::string* sheet) {
+    if (sheetPath) {
+        *sheet = sheetPath;
+        return true;
+    }
+    std::vector<std::string> palettes = findSpritePalettes();
+    if (palettes.empty()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No sprite palettes found");
+        return false;
+    }
+    *sheet = palettes[0];
+    return true;
+}
+
+}  // namespace
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    const char* tracePath = nullptr;
+    const char* outPath = nullptr;
+    const char* sheetPath = nullptr;
+    int threads = 0;
+    unsigned int seed = RENDER_SEED;
+    bool perfCounters = false;
+    double cpuBudget = -1;  // Off unless given
+    const char* powerSupplyPath = nullptr;
+    bool daemon = false;
+    std::vector<std::string> daemonDisplays;
+    std::string command;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--render") == 0 && i + 2 < argc) {
+            tracePath = argv[++i];
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--sheet") == 0 && i + 1 < argc) {
+            sheetPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--perf-counters") == 0) {
+            perfCounters = true;
+        } else if (strcmp(argv[i], "--cpu-budget") == 0 && i + 1 < argc) {
+            cpuBudget = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--power-supply") == 0 && i + 1 < argc) {
+            powerSupplyPath = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--daemon") == 0) {
+            daemon = true;
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                daemonDisplays.push_back(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--attach") == 0 && i + 1 < argc) {
+            command = std::string("attach ") + argv[++i];
+        } else if (strcmp(argv[i], "--detach") == 0 && i + 1 < argc) {
+            command = std::string("detach ") + argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Talk to a running daemon
+    if (!command.empty()) {
+        return CatDaemon::sendCommand(command) ? 0 : 1;
+    }
+
+    // Headless trace render, or the multi-display daemon: neither opens an SDL window
+    if (tracePath || daemon) {
+        if (cpuBudget >= 0 || powerSupplyPath) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "--cpu-budget and --power-supply don't apply to %s",
+                         daemon ? "--daemon" : "--render");
+            return 1;
+        }
+        if (perfCounters) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "--perf-counters doesn't apply to %s",
+                         daemon ? "--daemon" : "--render");
+            return 1;
+        }
+
+        // The screen locker's pkill -USR1/-USR2 hook is meant for the desktop cat;
+        // the default action would kill these. Set before any thread starts.
+        signal(SIGUSR1, SIG_IGN);
+        signal(SIGUSR2, SIG_IGN);
+
+        std::string sheet;
+        if (!pickSheet(sheetPath, &sheet)) {
+            return 1;
+        }
+
+        int imgFlags = IMG_INIT_PNG;
+        if (!(IMG_Init(imgFlags) & imgFlags)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_image init failed: %s", IMG_GetError());
+            return 1;
+        }
+
+        bool ok;
+        if (tracePath) {
+            TraceRenderer renderer;
+            ok = renderer.render(tracePath, sheet.c_str(), outPath, threads, seed);
+        } else {
+            // One process, one cat per X display
+            CatDaemon catDaemon;
+            ok = catDaemon.init(sheet.c_str());
+            for (size_t i = 0; ok && i < daemonDisplays.size(); i++) {
+                std::string reply;
+                if (!catDaemon.attach(daemonDisplays[i], &reply)) {
+                    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s", reply.c_str());
+                }
+            }
+            if (ok) {
+                ok = catDaemon.run();
+            }
+        }
+
+        IMG_Quit();
+        return ok ? 0 : 1;
+    }
+
+    // The AC state only scales the CPU budget
+    if (powerSupplyPath && cpuBudget < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "--power-supply needs --cpu-budget");
+        return 1;
+    }
 
     DesktopCat cat;
+    if (perfCounters && !cat.enableCounters()) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Running without performance counters");
+    }
+    if (cpuBudget >= 0 && !cat.enableGovernor(cpuBudget, powerSupplyPath)) {
+        return 1;
+    }
     cat.run();
 
     return 0;
@@ -0,0 +1,148 @@
+#include "include/phase_counters.h"
+#include <SDL2/SDL.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+struct CounterDef {
+    const char* name;
+    Uint32 type;
+    Uint64 config;
+};
+
+const CounterDef COUNTER_DEFS[COUNTER_COUNT] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"ctx-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"task-clock-ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}
+};
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {"events", "update", "shape", "present", "sleep"};
+
+int openCounter(const CounterDef& def, int groupFd, bool userOnly) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = def.type;
+    attr.config = def.config;
+    attr.disabled = groupFd < 0;  // The leader starts the whole group at once
+    attr.exclude_kernel = userOnly;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // This thread only, on any CPU
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+}  // namespace
+
+PhaseCounters::PhaseCounters() : groupFd(-1), openCount(0), current(PHASE_EVENTS), frames(0) {
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        fds[c] = -1;
+        slots[c] = -1;
+        last[c] = 0.0;
+    }
+    memset(totals, 0, sizeof(totals));
+}
+
+PhaseCounters::~PhaseCounters() {
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        if (fds[c] >= 0) {
+            close(fds[c]);
+        }
+    }
+}
+
+bool PhaseCounters::enable() {
+    if (groupFd >= 0) {
+        return true;
+    }
+
+    int lastErrno = 0;
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        // Kernel-side counts need a permissive perf_event_paranoid; fall back to user space only
+        int fd = openCounter(COUNTER_DEFS[c], groupFd, false);
+        if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+            fd = openCounter(COUNTER_DEFS[c], groupFd, true);
+        }
+        if (fd < 0) {
+            lastErrno = errno;
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Counter %s unavailable: %s",
+                        COUNTER_DEFS[c].name, strerror(errno));
+            continue;
+        }
+
+        fds[c] = fd;
+        slots[c] = openCount++;
+        if (groupFd < 0) {
+            groupFd = fd;
+        }
+    }
+
+    if (groupFd < 0) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                    "No performance counters available (%s), see /proc/sys/kernel/perf_event_paranoid",
+                    strerror(lastErrno));
+        return false;
+    }
+
+    ioctl(groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    readGroup(last);
+    return true;
+}
+
+bool PhaseCounters::readGroup(double* values) const {
+    // nr, time enabled, time running, then one value per open counter
+    Uint64 buffer[3 + COUNTER_COUNT];
+    ssize_t expected = (ssize_t)((3 + openCount) * sizeof(Uint64));
+    if (read(groupFd, buffer, sizeof(buffer)) != expected) {
+        return false;
+    }
+
+    // Scale up if the group was multiplexed off the PMU part of the time
+    double scale = 1.0;
+    if (buffer[2] > 0 && buffer[2] < buffer[1]) {
+        scale = (double)buffer[1] / (double)buffer[2];
+    }
+
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        values[c] = slots[c] >= 0 ? buffer[3 + slots[c]] * scale : 0.0;
+    }
+    return true;
+}
+
+void PhaseCounters::switchPhase(Phase next) {
+    double now[COUNTER_COUNT];
+    if (readGroup(now)) {
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            totals[current][c] += now[c] - last[c];
+            last[c] = now[c];
+        }
+    }
+    current = next;
+}
+
+void PhaseCounters::report() {
+    if (groupFd < 0) {
+        return;
+    }
+    switchPhase(current);
+
+    unsigned long long perFrame = frames ? frames : 1;
+    SDL_Log("Performance counters over %llu frame(s), total / per frame:", frames);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        SDL_Log("  %s", PHASE_NAMES[p]);
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            if (slots[c] < 0) continue;
+            SDL_Log("    %-14s %16.0f %14.1f", COUNTER_DEFS[c].name,
+                    totals[p][c], totals[p][c] / perFrame);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "include/power_watch.h"
+#include <X11/extensions/scrnsaver.h>
+#include <X11/extensions/dpms.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+namespace {
+
+// Cycle is sent when the saver changes pattern: it is still covering the screen
+bool saverShowing(int state) {
+    return state == ScreenSaverOn || state == ScreenSaverCycle;
+}
+
+}  // namespace
+
+PowerWatch::PowerWatch() : display(nullptr), saverEventBase(-1), dpmsReady(false),
+                           saverActive(false), dpmsOff(false), locked(false), signalFd(-1) {
+}
+
+PowerWatch::~PowerWatch() {
+    if (signalFd >= 0) {
+        close(signalFd);
+    }
+}
+
+void PowerWatch::blockLockSignals() {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGUSR2);
+
+    // Deliver the signals through a descriptor instead of an async handler
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) == 0) {
+        signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    }
+}
+
+void PowerWatch::refreshDpms() {
+    if (!dpmsReady) {
+        return;
+    }
+
+    CARD16 level;
+    BOOL enabled;
+    if (DPMSInfo(display, &level, &enabled)) {
+        dpmsOff = enabled && level != DPMSModeOn;
+    }
+}
+
+bool PowerWatch::init(Display* dpy) {
+    display = dpy;
+    Window root = DefaultRootWindow(display);
+
+    int dpmsEvent, dpmsError;
+    dpmsReady = DPMSQueryExtension(display, &dpmsEvent, &dpmsError) && DPMSCapable(display);
+
+    // DPMS has no events of its own; the server activates the screen saver
+    // whenever it powers the monitor down, so the notify covers both
+    int saverError;
+    if (!XScreenSaverQueryExtension(display, &saverEventBase, &saverError)) {
+        saverEventBase = -1;
+        return false;
+    }
+    XScreenSaverSelectInput(display, root, ScreenSaverNotifyMask);
+
+    // Initial state, in case we start behind a blanked screen
+    XScreenSaverInfo* info = XScreenSaverAllocInfo();
+    if (info) {
+        if (XScreenSaverQueryInfo(display, root, info)) {
+            saverActive = saverShowing(info->state);
+        }
+        XFree(info);
+    }
+    refreshDpms();
+
+    return true;
+}
+
+bool PowerWatch::handleEvent(const XEvent& event) {
+    if (saverEventBase < 0 || event.type != saverEventBase + ScreenSaverNotify) {
+        return false;
+    }
+
+    const XScreenSaverNotifyEvent& notify = (const XScreenSaverNotifyEvent&)event;
+    saverActive = saverShowing(notify.state);
+    refreshDpms();
+    return true;
+}
+
+void PowerWatch::handleSignals() {
+    if (signalFd < 0) {
+        return;
+    }
+
+    struct signalfd_siginfo info;
+    while (read(signalFd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+        if (info.ssi_signo == SIGUSR1) {
+            locked = true;
+        } else if (info.ssi_signo == SIGUSR2) {
+            locked = false;
+        }
+    }
+}
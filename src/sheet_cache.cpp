@@ -0,0 +1,462 @@
+#include "include/sheet_cache.h"
+#include <SDL2/SDL_image.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct SheetEntryHeader {
+    char magic[8];
+    Uint32 version;
+    Uint32 width, height, pitch, frameSize;
+    Uint32 cellCount, rectCount;
+    Uint32 pixelsOffset;  // RGBA32 rows, pitch bytes apart
+    Uint32 cellsOffset;   // cellCount + 1 indexes into the rectangles, row-major cells
+    Uint32 rectsOffset;   // YX-banded rectangles of every cell, back to back
+    Uint32 totalSize;
+};
+
+namespace {
+
+const char SHEET_MAGIC[8] = {'M', 'C', 'S', 'H', 'E', 'E', 'T', '\0'};
+const char* const SHEET_ENTRY_PREFIX = "mousecat-sheet-";  // Followed by <uid>-<16 hex digits>
+const size_t SHEET_HASH_DIGITS = 16;
+
+struct EntryLayout {
+    size_t pixels, cells, rects, total;
+};
+
+size_t alignUp(size_t n, size_t alignment) {
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+EntryLayout entryLayout(int width, int height, int cellCount, size_t rectCount) {
+    EntryLayout layout;
+    layout.pixels = alignUp(sizeof(SheetEntryHeader), 64);
+    layout.cells = layout.pixels + (size_t)width * 4 * height;
+    layout.rects = alignUp(layout.cells + (cellCount + 1) * sizeof(Uint32), sizeof(XRectangle));
+    layout.total = layout.rects + rectCount * sizeof(XRectangle);
+    return layout;
+}
+
+// FNV-1a, enough to tell cache entries apart
+Uint64 hashBytes(Uint64 hash, const void* data, size_t length) {
+    const Uint8* bytes = (const Uint8*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+MappedSheet::MappedSheet()
+    : base(nullptr), size(0), valid(false), width(0), height(0), pitch(0), cellSize(0), pixelsOffset(0) {
+}
+
+MappedSheet::~MappedSheet() {
+    if (base) {
+        munmap(base, size);
+    }
+}
+
+bool MappedSheet::attach(void* mapping, size_t length) {
+    base = mapping;
+    size = length;
+
+    // Copy the header out so a later change to the file can't move an offset we checked
+    SheetEntryHeader h;
+    if (length < sizeof(SheetEntryHeader)) {
+        return false;
+    }
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, SHEET_MAGIC, sizeof(SHEET_MAGIC)) != 0 || h.version != SHEET_CACHE_VERSION) {
+        return false;
+    }
+    if (detectFrameSize(h.width, h.height) != (int)h.frameSize || h.pitch != h.width * 4) {
+        return false;
+    }
+
+    int columns = h.width / h.frameSize;
+    int rows = h.height / h.frameSize;
+    if (h.cellCount != (Uint32)(columns * rows)) {
+        return false;
+    }
+
+    EntryLayout layout = entryLayout(h.width, h.height, h.cellCount, h.rectCount);
+    if (h.pixelsOffset != layout.pixels || h.cellsOffset != layout.cells ||
+        h.rectsOffset != layout.rects || h.totalSize != layout.total || layout.total > length) {
+        return false;
+    }
+
+    // Shapes are small: keep private copies, checked once, and never read them from the file again
+    const Uint8* bytes = (const Uint8*)base;
+    std::vector<Uint32> cells(h.cellCount + 1);
+    std::vector<XRectangle> rects(h.rectCount);
+    memcpy(cells.data(), bytes + layout.cells, cells.size() * sizeof(Uint32));
+    memcpy(rects.data(), bytes + layout.rects, rects.size() * sizeof(XRectangle));
+
+    if (cells[0] != 0 || cells[h.cellCount] != h.rectCount) {
+        return false;
+    }
+    for (Uint32 i = 0; i < h.cellCount; i++) {
+        if (cells[i] > cells[i + 1]) {
+            return false;
+        }
+    }
+    for (const XRectangle& r : rects) {
+        if (r.x < 0 || r.y < 0 || r.x + r.width > (int)h.frameSize || r.y + r.height > (int)h.frameSize) {
+            return false;
+        }
+    }
+
+    width = h.width;
+    height = h.height;
+    pitch = h.pitch;
+    cellSize = h.frameSize;
+    pixelsOffset = layout.pixels;
+    cellStarts.swap(cells);
+    shapeRects.swap(rects);
+    valid = true;
+    return true;
+}
+
+int MappedSheet::frameSize() const {
+    return valid ? cellSize : 0;
+}
+
+SDL_Surface* MappedSheet::createSurface() const {
+    if (!valid) {
+        return nullptr;
+    }
+    void* pixels = (Uint8*)base + pixelsOffset;
+    return SDL_CreateRGBSurfaceWithFormatFrom(pixels, width, height, 32, pitch, SDL_PIXELFORMAT_RGBA32);
+}
+
+bool MappedSheet::cellShape(int column, int row, std::vector<XRectangle>* rects) const {
+    int columns = valid ? width / cellSize : 0;
+    int rows = valid ? height / cellSize : 0;
+    if (column < 0 || row < 0 || column >= columns || row >= rows) {
+        return false;
+    }
+
+    int cell = row * columns + column;
+    rects->assign(shapeRects.begin() + cellStarts[cell], shapeRects.begin() + cellStarts[cell + 1]);
+    return true;
+}
+
+size_t MappedSheet::entrySize(int width, int height, int cellCount, size_t rectCount) {
+    return entryLayout(width, height, cellCount, rectCount).total;
+}
+
+void MappedSheet::writeEntry(Uint8* dst, const SDL_Surface* rgba, int frameSize,
+                             const std::vector<std::vector<XRectangle>>& shapes) {
+    size_t rectCount = 0;
+    for (const std::vector<XRectangle>& shape : shapes) {
+        rectCount += shape.size();
+    }
+    EntryLayout layout = entryLayout(rgba->w, rgba->h, (int)shapes.size(), rectCount);
+
+    SheetEntryHeader* h = (SheetEntryHeader*)dst;
+    memset(h, 0, sizeof(SheetEntryHeader));
+    memcpy(h->magic, SHEET_MAGIC, sizeof(SHEET_MAGIC));
+    h->version = SHEET_CACHE_VERSION;
+    h->width = rgba->w;
+    h->height = rgba->h;
+    h->pitch = rgba->w * 4;
+    h->frameSize = frameSize;
+    h->cellCount = (Uint32)shapes.size();
+    h->rectCount = (Uint32)rectCount;
+    h->pixelsOffset = (Uint32)layout.pixels;
+    h->cellsOffset = (Uint32)layout.cells;
+    h->rectsOffset = (Uint32)layout.rects;
+    h->totalSize = (Uint32)layout.total;
+
+    // Rows packed tightly, whatever pitch the decoder used
+    for (int y = 0; y < rgba->h; y++) {
+        memcpy(dst + layout.pixels + (size_t)y * h->pitch,
+               (const Uint8*)rgba->pixels + (size_t)y * rgba->pitch, h->pitch);
+    }
+
+    Uint32* cells = (Uint32*)(dst + layout.cells);
+    XRectangle* rects = (XRectangle*)(dst + layout.rects);
+    Uint32 next = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        cells[i] = next;
+        memcpy(rects + next, shapes[i].data(), shapes[i].size() * sizeof(XRectangle));
+        next += (Uint32)shapes[i].size();
+    }
+    cells[shapes.size()] = next;
+}
+
+SheetCache::SheetCache() : shared(false) {
+}
+
+bool SheetCache::init() {
+    const char* dir = getenv(SHEET_CACHE_DIR_ENV);
+    shared = dir && *dir;
+    if (!shared) {
+        dir = getenv("XDG_RUNTIME_DIR");
+    }
+    if (!dir || !*dir) {
+        return false;
+    }
+
+    struct stat st;
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Sprite cache directory %s unusable", dir);
+        return false;
+    }
+
+    directory = dir;
+    removeStaleEntries();
+    return true;
+}
+
+void SheetCache::removeStaleEntries() const {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+
+    // Names hash the layout version, so entries of an older layout are never opened again.
+    // Names without a uid predate it and are never opened either.
+    int removed = 0;
+    char ownPrefix[64];
+    snprintf(ownPrefix, sizeof(ownPrefix), "%s%u-", SHEET_ENTRY_PREFIX, (unsigned int)getuid());
+    const size_t ownLength = strlen(ownPrefix);
+    const size_t legacyLength = strlen(SHEET_ENTRY_PREFIX);
+    while (struct dirent* ent = readdir(dir)) {
+        size_t length = strlen(ent->d_name);
+        bool own = strncmp(ent->d_name, ownPrefix, ownLength) == 0 && length == ownLength + SHEET_HASH_DIGITS;
+        bool legacy = strncmp(ent->d_name, SHEET_ENTRY_PREFIX, legacyLength) == 0 &&
+                      length == legacyLength + SHEET_HASH_DIGITS && !strchr(ent->d_name + legacyLength, '-');
+        if (!own && !legacy) {
+            continue;  // Not our entry, or a temporary still being written
+        }
+
+        int fd = openat(dirfd(dir), ent->d_name, O_RDONLY | O_CLOEXEC | O_NOFOLLOW | O_NONBLOCK);
+        if (fd < 0) {
+            continue;
+        }
+        struct stat st;
+        SheetEntryHeader h;
+        bool ours = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == getuid();
+        bool current = pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+                       memcmp(h.magic, SHEET_MAGIC, sizeof(SHEET_MAGIC)) == 0 &&
+                       h.version == SHEET_CACHE_VERSION;
+        close(fd);
+
+        if (ours && (legacy || !current) && unlinkat(dirfd(dir), ent->d_name, 0) == 0) {
+            removed++;
+        }
+    }
+    closedir(dir);
+
+    if (removed) {
+        SDL_Log("Removed %d stale sprite cache entr%s from %s", removed, removed == 1 ? "y" : "ies",
+                directory.c_str());
+    }
+}
+
+bool SheetCache::entryPath(const char* sheetPath, uid_t owner, std::string* path) const {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (!realpath(sheetPath, resolved) || stat(resolved, &st) != 0) {
+        return false;
+    }
+
+    // A palette edited in place gets a new entry
+    Uint64 hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, resolved, strlen(resolved));
+    hash = hashBytes(hash, &st.st_dev, sizeof(st.st_dev));
+    hash = hashBytes(hash, &st.st_ino, sizeof(st.st_ino));
+    hash = hashBytes(hash, &st.st_size, sizeof(st.st_size));
+    hash = hashBytes(hash, &st.st_mtim, sizeof(st.st_mtim));
+    hash = hashBytes(hash, &SHEET_CACHE_VERSION, sizeof(SHEET_CACHE_VERSION));
+
+    // Users publish under their own names: in a sticky directory nobody can replace another's entry
+    char name[64];
+    snprintf(name, sizeof(name), "/%s%u-%016llx", SHEET_ENTRY_PREFIX, (unsigned int)owner,
+             (unsigned long long)hash);
+    *path = directory + name;
+    return true;
+}
+
+MappedSheet* SheetCache::open(const char* sheetPath) const {
+    // Our own entry, else one root published for everybody
+    uid_t owners[] = {getuid(), 0};
+    for (int i = 0; i < (owners[0] == 0 ? 1 : 2); i++) {
+        std::string path;
+        if (!enabled() || !entryPath(sheetPath, owners[i], &path)) {
+            return nullptr;
+        }
+        MappedSheet* sheet = openEntry(path, owners[i]);
+        if (sheet) {
+            return sheet;
+        }
+    }
+    return nullptr;
+}
+
+MappedSheet* SheetCache::openEntry(const std::string& path, uid_t owner) const {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        return nullptr;  // Nobody published this sheet yet
+    }
+
+    // A writable entry could change (or shrink) under every process mapping it
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH))) {
+        close(fd);
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Ignoring writable sprite cache entry %s", path.c_str());
+        return nullptr;
+    }
+
+    // Anyone else could chmod it writable and truncate it later, faulting us on access
+    if (st.st_uid != owner) {
+        close(fd);
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Ignoring sprite cache entry %s owned by uid %u",
+                    path.c_str(), (unsigned int)st.st_uid);
+        return nullptr;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    MappedSheet* sheet = new MappedSheet();
+    if (!sheet->attach(mapping, st.st_size)) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Ignoring invalid sprite cache entry %s", path.c_str());
+        delete sheet;
+        return nullptr;
+    }
+    return sheet;
+}
+
+MappedSheet* SheetCache::store(const char* sheetPath, const SDL_Surface* rgba,
+                               const SpriteKernels* kernels) const {
+    std::string path;
+    if (!enabled() || !kernels || !entryPath(sheetPath, getuid(), &path)) {
+        return nullptr;
+    }
+
+    // Pack every cell's shape now so later sessions skip that too
+    int frameSize = kernels->frameSize;
+    int columns = rgba->w / frameSize;
+    int rows = rgba->h / frameSize;
+    std::vector<std::vector<XRectangle>> shapes(columns * rows);
+    size_t rectCount = 0;
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            const Uint8* cell = (const Uint8*)rgba->pixels +
+                                row * frameSize * rgba->pitch + column * frameSize * 4;
+            std::vector<XRectangle>& shape = shapes[row * columns + column];
+            kernels->packShape(cell, rgba->pitch, &shape);
+            rectCount += shape.size();
+        }
+    }
+    size_t length = MappedSheet::entrySize(rgba->w, rgba->h, columns * rows, rectCount);
+
+    // Build under a temporary name so no process ever maps a partial entry
+    std::string temp = path + ".XXXXXX";
+    std::vector<char> tempPath(temp.begin(), temp.end());
+    tempPath.push_back('\0');
+
+    int fd = mkostemp(tempPath.data(), O_CLOEXEC);
+    if (fd < 0) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to create sprite cache entry in %s: %s",
+                    directory.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    // Read-only from the start: other users may read a shared entry, nobody may write it
+    void* mapping = MAP_FAILED;
+    bool ok = fchmod(fd, shared ? 0444 : 0400) == 0 && ftruncate(fd, length) == 0;
+    if (ok) {
+        mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = mapping != MAP_FAILED;
+    }
+    if (ok) {
+        MappedSheet::writeEntry((Uint8*)mapping, rgba, frameSize, shapes);
+        ok = mprotect(mapping, length, PROT_READ) == 0 && rename(tempPath.data(), path.c_str()) == 0;
+    }
+    close(fd);
+
+    if (!ok) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to publish sprite cache entry %s: %s",
+                    path.c_str(), strerror(errno));
+        if (mapping != MAP_FAILED) {
+            munmap(mapping, length);
+        }
+        unlink(tempPath.data());
+        return nullptr;
+    }
+
+    MappedSheet* sheet = new MappedSheet();
+    if (!sheet->attach(mapping, length)) {
+        delete sheet;
+        return nullptr;
+    }
+    return sheet;
+}
+
+SDL_Surface* SheetCache::load(const char* sheetPath, MappedSheet** mapped) const {
+    // Another session may already have decoded this palette
+    MappedSheet* entry = open(sheetPath);
+    SDL_Surface* converted = nullptr;
+
+    if (entry) {
+        converted = entry->createSurface();
+    } else {
+        SDL_Surface* surface = IMG_Load(sheetPath);
+        if (!surface) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load sprite: %s", IMG_GetError());
+            return nullptr;
+        }
+
+        // Convert surface to RGBA for proper transparency
+        converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(surface);
+    }
+
+    if (!converted) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to convert surface: %s", SDL_GetError());
+        delete entry;
+        return nullptr;
+    }
+
+    // Cell size follows from the sheet's dimensions
+    int frameSize = detectFrameSize(converted->w, converted->h);
+    if (!frameSize) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unsupported sprite sheet size %dx%d: %s",
+                     converted->w, converted->h, sheetPath);
+        SDL_FreeSurface(converted);
+        delete entry;
+        return nullptr;
+    }
+
+    // Publish a fresh decode for later sessions, and use the shared copy here too
+    if (!entry) {
+        entry = store(sheetPath, converted, spriteKernelsFor(frameSize));
+        SDL_Surface* sharedSurface = entry ? entry->createSurface() : nullptr;
+        if (sharedSurface) {
+            SDL_FreeSurface(converted);
+            converted = sharedSurface;
+        } else {
+            delete entry;
+            entry = nullptr;
+        }
+    }
+
+    *mapped = entry;
+    return converted;
+}
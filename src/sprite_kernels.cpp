@@ -0,0 +1,91 @@
+#include "include/sprite_kernels.h"
+
+namespace {
+
+template <int N>
+void packShape(const Uint8* cell, int pitch, std::vector<XRectangle>* rects) {
+    static_assert(N <= 64, "a row must fit in one 64-bit mask");
+
+    rects->clear();
+    size_t bandStart = 0;  // First rectangle of the previous row's band
+    size_t bandCount = 0;
+    Uint64 bandMask = 0;
+
+    for (int y = 0; y < N; y++) {
+        // Threshold the row into a bit mask, bit x set for opaque pixels
+        const Uint8* row = cell + y * pitch;
+        Uint64 mask = 0;
+        for (int x = 0; x < N; x++) {
+            mask |= (Uint64)(row[x * 4 + 3] > SHAPE_ALPHA_THRESHOLD) << x;
+        }
+
+        // Rows with the same runs as the one above just grow that band
+        if (y > 0 && mask == bandMask) {
+            for (size_t i = 0; i < bandCount; i++) {
+                (*rects)[bandStart + i].height++;
+            }
+            continue;
+        }
+
+        bandStart = rects->size();
+        bandMask = mask;
+
+        // Each run of set bits becomes one rectangle
+        while (mask) {
+            int start = __builtin_ctzll(mask);
+            Uint64 gaps = ~(mask >> start);
+            int length = gaps ? __builtin_ctzll(gaps) : 64 - start;
+
+            XRectangle run = {(short)start, (short)y, (unsigned short)length, 1};
+            rects->push_back(run);
+
+            mask = (start + length < 64) ? mask & (~0ULL << (start + length)) : 0;
+        }
+        bandCount = rects->size() - bandStart;
+    }
+}
+
+template <int N>
+void blend(const Uint8* cell, int pitch, Uint8* dst, int dstPitch) {
+    for (int y = 0; y < N; y++) {
+        const Uint8* src = cell + y * pitch;
+        Uint8* out = dst + y * dstPitch;
+
+        for (int x = 0; x < N; x++, src += 4, out += 4) {
+            int alpha = src[3];
+            for (int c = 0; c < 3; c++) {
+                out[c] = (Uint8)((src[c] * alpha + out[c] * (255 - alpha) + 127) / 255);
+            }
+        }
+    }
+}
+
+const SpriteKernels KERNELS[] = {
+    {16, packShape<16>, blend<16>},
+    {32, packShape<32>, blend<32>},
+    {48, packShape<48>, blend<48>},
+    {64, packShape<64>, blend<64>}
+};
+
+}  // namespace
+
+int detectFrameSize(int sheetWidth, int sheetHeight) {
+    if (sheetWidth % SHEET_COLUMNS != 0) {
+        return 0;
+    }
+
+    int frameSize = sheetWidth / SHEET_COLUMNS;
+    if (!spriteKernelsFor(frameSize) || sheetHeight < frameSize * SHEET_ROWS) {
+        return 0;
+    }
+    return frameSize;
+}
+
+const SpriteKernels* spriteKernelsFor(int frameSize) {
+    for (const SpriteKernels& kernels : KERNELS) {
+        if (kernels.frameSize == frameSize) {
+            return &kernels;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,395 @@
+#include "include/trace_renderer.h"
+#include "include/cat_behavior.h"
+#include "include/sprite_kernels.h"
+#include <SDL2/SDL_image.h>
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+const Uint8 BACKGROUND_RGBA[4] = {0xF0, 0xF0, 0xF0, 0xFF};
+const Uint8 CURSOR_RGBA[4] = {0xE0, 0x20, 0x20, 0xFF};
+const Uint8 PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+void putU32(std::vector<Uint8>* buf, Uint32 v) {
+    buf->push_back((Uint8)(v >> 24));
+    buf->push_back((Uint8)(v >> 16));
+    buf->push_back((Uint8)(v >> 8));
+    buf->push_back((Uint8)v);
+}
+
+void putU16(std::vector<Uint8>* buf, Uint16 v) {
+    buf->push_back((Uint8)(v >> 8));
+    buf->push_back((Uint8)v);
+}
+
+// PNG chunk: length, type, head + data, CRC over everything after the length
+bool writeChunk(FILE* out, const char* type, const std::vector<Uint8>& head,
+                const Uint8* data = nullptr, size_t dataLen = 0) {
+    std::vector<Uint8> length;
+    putU32(&length, (Uint32)(head.size() + dataLen));
+
+    uLong crc = crc32(0L, (const Bytef*)type, 4);
+    if (!head.empty()) crc = crc32(crc, head.data(), (uInt)head.size());
+    if (dataLen) crc = crc32(crc, data, (uInt)dataLen);
+
+    std::vector<Uint8> trailer;
+    putU32(&trailer, (Uint32)crc);
+
+    return fwrite(length.data(), 1, 4, out) == 4 &&
+           fwrite(type, 1, 4, out) == 4 &&
+           fwrite(head.data(), 1, head.size(), out) == head.size() &&
+           (!dataLen || fwrite(data, 1, dataLen, out) == dataLen) &&
+           fwrite(trailer.data(), 1, 4, out) == 4;
+}
+
+SDL_Rect centeredRect(int x, int y, int size) {
+    SDL_Rect r = {x - size / 2, y - size / 2, size, size};
+    return r;
+}
+
+}  // namespace
+
+TraceRenderer::TraceRenderer()
+    : spriteSheet(nullptr), spriteSize(0), kernels(nullptr),
+      canvasW(0), canvasH(0), originX(0), originY(0), ticks(0) {
+}
+
+TraceRenderer::~TraceRenderer() {
+    if (spriteSheet) {
+        SDL_FreeSurface(spriteSheet);
+    }
+}
+
+bool TraceRenderer::loadTrace(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to open trace: %s", path);
+        return false;
+    }
+
+    trace.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        unsigned int timeMs;
+        int x, y;
+        if (line[0] == '#' || sscanf(line, "%u %d %d", &timeMs, &x, &y) != 3) {
+            continue;  // Comments and blank lines
+        }
+        TraceSample sample = {(Uint32)timeMs, x, y};
+        trace.push_back(sample);
+    }
+    fclose(file);
+
+    if (trace.empty()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No samples in trace: %s", path);
+        return false;
+    }
+
+    // Tolerate traces merged from several sources
+    std::stable_sort(trace.begin(), trace.end(), [](const TraceSample& a, const TraceSample& b) {
+        return a.timeMs < b.timeMs;
+    });
+    return true;
+}
+
+bool TraceRenderer::loadSheet(const char* path) {
+    SDL_Surface* surface = IMG_Load(path);
+    if (!surface) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load sprite: %s", IMG_GetError());
+        return false;
+    }
+
+    // Same layout the live cat uses, so pixels can be read straight as R, G, B, A bytes
+    spriteSheet = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+
+    if (!spriteSheet) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to convert surface: %s", SDL_GetError());
+        return false;
+    }
+
+    spriteSize = detectFrameSize(spriteSheet->w, spriteSheet->h);
+    if (!spriteSize) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unsupported sprite sheet size %dx%d: %s",
+                     spriteSheet->w, spriteSheet->h, path);
+        return false;
+    }
+    kernels = spriteKernelsFor(spriteSize);
+
+    fillFrameTable(frameTable, spriteSize);
+    return true;
+}
+
+void TraceRenderer::simulate() {
+    // Canvas covers the trace plus room for the cat to run around it
+    int minX = trace[0].x, maxX = trace[0].x;
+    int minY = trace[0].y, maxY = trace[0].y;
+    for (const TraceSample& sample : trace) {
+        minX = std::min(minX, sample.x);
+        maxX = std::max(maxX, sample.x);
+        minY = std::min(minY, sample.y);
+        maxY = std::max(maxY, sample.y);
+    }
+    originX = minX - TRACE_CANVAS_MARGIN;
+    originY = minY - TRACE_CANVAS_MARGIN;
+    canvasW = maxX - minX + 1 + 2 * TRACE_CANVAS_MARGIN;
+    canvasH = maxY - minY + 1 + 2 * TRACE_CANVAS_MARGIN;
+
+    const Uint32 tickMs = 1000 / FPS;
+    const Uint32 start = trace.front().timeMs;
+    const Uint32 end = trace.back().timeMs;
+    const SDL_Rect canvas = {0, 0, canvasW, canvasH};
+
+    size_t next = 0;
+    int mouseX = trace[0].x;
+    int mouseY = trace[0].y;
+
+    // Start mid-canvas like the live cat starts mid-display; no windows to perch on
+    CatBehavior behavior(frameTable, nullptr, originX + canvasW / 2.0, originY + canvasH / 2.0,
+                         mouseX, mouseY, start);
+
+    snapshots.clear();
+    ticks = 0;
+
+    for (Uint32 now = start; ; now += tickMs) {
+        // Hold the latest sample, as polling the pointer would
+        while (next < trace.size() && trace[next].timeMs <= now) {
+            mouseX = trace[next].x;
+            mouseY = trace[next].y;
+            next++;
+        }
+
+        behavior.update(mouseX, mouseY, now);
+        ticks++;
+
+        Snapshot snap;
+        snap.catX = (int)(behavior.getX() - spriteSize/2) - originX;
+        snap.catY = (int)(behavior.getY() - spriteSize/2) - originY;
+        snap.src = behavior.currentFrame().src;
+        snap.cursorX = mouseX - originX;
+        snap.cursorY = mouseY - originY;
+        snap.dirty = canvas;
+        snap.durationMs = tickMs;
+
+        if (!snapshots.empty()) {
+            Snapshot& prev = snapshots.back();
+            bool unchanged = snap.catX == prev.catX && snap.catY == prev.catY &&
+                             SDL_RectEquals(&snap.src, &prev.src) &&
+                             snap.cursorX == prev.cursorX && snap.cursorY == prev.cursorY;
+
+            // Still scenes (idling, sleeping) become one long frame
+            if (unchanged && prev.durationMs + tickMs <= APNG_MAX_DELAY_MS) {
+                prev.durationMs += tickMs;
+                if (now >= end) break;
+                continue;
+            }
+
+            // Only redraw where the cat or cursor was or now is
+            SDL_Rect area = {prev.catX, prev.catY, spriteSize, spriteSize};
+            SDL_Rect r = {snap.catX, snap.catY, spriteSize, spriteSize};
+            SDL_UnionRect(&area, &r, &area);
+            r = centeredRect(prev.cursorX, prev.cursorY, TRACE_CURSOR_SIZE);
+            SDL_UnionRect(&area, &r, &area);
+            r = centeredRect(snap.cursorX, snap.cursorY, TRACE_CURSOR_SIZE);
+            SDL_UnionRect(&area, &r, &area);
+
+            if (!SDL_IntersectRect(&area, &canvas, &snap.dirty)) {
+                // Both off canvas: APNG frames can't be empty
+                SDL_Rect pixel = {0, 0, 1, 1};
+                snap.dirty = pixel;
+            }
+        }
+        snapshots.push_back(snap);
+
+        if (now >= end) break;
+    }
+}
+
+void TraceRenderer::composite(const Snapshot& snap, std::vector<Uint8>* scanlines) const {
+    const SDL_Rect& area = snap.dirty;
+    const size_t stride = 1 + (size_t)area.w * 4;  // Filter type byte, then RGBA pixels
+
+    scanlines->resize(stride * area.h);
+    for (int y = 0; y < area.h; y++) {
+        Uint8* row = scanlines->data() + y * stride;
+        row[0] = 0;  // No filter
+        for (int x = 0; x < area.w; x++) {
+            std::copy(BACKGROUND_RGBA, BACKGROUND_RGBA + 4, row + 1 + x * 4);
+        }
+    }
+
+    // Canvas pixel inside the redrawn area, or null
+    auto pixelAt = [&](int x, int y) -> Uint8* {
+        if (x < area.x || y < area.y || x >= area.x + area.w || y >= area.y + area.h) {
+            return nullptr;
+        }
+        return scanlines->data() + (y - area.y) * stride + 1 + (x - area.x) * 4;
+    };
+
+    // Sprite cell blended over the background, the way the renderer's BLEND mode copies it
+    const Uint8* sheet = (const Uint8*)spriteSheet->pixels;
+    const Uint8* cell = sheet + snap.src.y * spriteSheet->pitch + snap.src.x * 4;
+    Uint8* topLeft = pixelAt(snap.catX, snap.catY);
+    Uint8* bottomRight = pixelAt(snap.catX + spriteSize - 1, snap.catY + spriteSize - 1);
+    if (topLeft && bottomRight) {
+        kernels->blend(cell, spriteSheet->pitch, topLeft, (int)stride);
+    } else {
+        // Clipped at the canvas edge: pixel by pixel
+        for (int sy = 0; sy < snap.src.h && snap.src.y + sy < spriteSheet->h; sy++) {
+            for (int sx = 0; sx < snap.src.w && snap.src.x + sx < spriteSheet->w; sx++) {
+                Uint8* dst = pixelAt(snap.catX + sx, snap.catY + sy);
+                if (!dst) continue;
+
+                const Uint8* src = sheet + (snap.src.y + sy) * spriteSheet->pitch + (snap.src.x + sx) * 4;
+                int alpha = src[3];
+                for (int c = 0; c < 3; c++) {
+                    dst[c] = (Uint8)((src[c] * alpha + dst[c] * (255 - alpha) + 127) / 255);
+                }
+            }
+        }
+    }
+
+    // Cursor crosshair on top
+    for (int i = -TRACE_CURSOR_SIZE / 2; i <= TRACE_CURSOR_SIZE / 2; i++) {
+        Uint8* h = pixelAt(snap.cursorX + i, snap.cursorY);
+        Uint8* v = pixelAt(snap.cursorX, snap.cursorY + i);
+        if (h) std::copy(CURSOR_RGBA, CURSOR_RGBA + 4, h);
+        if (v) std::copy(CURSOR_RGBA, CURSOR_RGBA + 4, v);
+    }
+}
+
+bool TraceRenderer::encodeFrames(size_t first, size_t last,
+                                 std::vector<std::vector<Uint8>>* encoded) const {
+    std::vector<Uint8> scanlines;
+
+    for (size_t i = first; i < last; i++) {
+        composite(snapshots[i], &scanlines);
+
+        std::vector<Uint8>& out = (*encoded)[i];
+        uLongf outLen = compressBound((uLong)scanlines.size());
+        out.resize(outLen);
+        if (compress2(out.data(), &outLen, scanlines.data(), (uLong)scanlines.size(),
+                      Z_DEFAULT_COMPRESSION) != Z_OK) {
+            return false;
+        }
+        out.resize(outLen);
+    }
+    return true;
+}
+
+bool TraceRenderer::writeApng(const char* path, const std::vector<std::vector<Uint8>>& encoded) const {
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create %s", path);
+        return false;
+    }
+
+    bool ok = fwrite(PNG_SIGNATURE, 1, sizeof(PNG_SIGNATURE), out) == sizeof(PNG_SIGNATURE);
+
+    // 8-bit RGBA, no interlace
+    std::vector<Uint8> header;
+    putU32(&header, canvasW);
+    putU32(&header, canvasH);
+    header.push_back(8);
+    header.push_back(6);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    ok = ok && writeChunk(out, "IHDR", header);
+
+    // Frame count, loop forever
+    std::vector<Uint8> control;
+    putU32(&control, (Uint32)snapshots.size());
+    putU32(&control, 0);
+    ok = ok && writeChunk(out, "acTL", control);
+
+    // The first frame is the full canvas and doubles as the still image (IDAT);
+    // later frames only replace their dirty area (fdAT)
+    Uint32 sequence = 0;
+    for (size_t i = 0; ok && i < snapshots.size(); i++) {
+        const Snapshot& snap = snapshots[i];
+
+        std::vector<Uint8> frameControl;
+        putU32(&frameControl, sequence++);
+        putU32(&frameControl, snap.dirty.w);
+        putU32(&frameControl, snap.dirty.h);
+        putU32(&frameControl, snap.dirty.x);
+        putU32(&frameControl, snap.dirty.y);
+        putU16(&frameControl, (Uint16)snap.durationMs);
+        putU16(&frameControl, 1000);
+        frameControl.push_back(0);  // APNG_DISPOSE_OP_NONE
+        frameControl.push_back(0);  // APNG_BLEND_OP_SOURCE
+        ok = writeChunk(out, "fcTL", frameControl);
+
+        if (i == 0) {
+            ok = ok && writeChunk(out, "IDAT", std::vector<Uint8>(), encoded[i].data(), encoded[i].size());
+        } else {
+            std::vector<Uint8> frameSequence;
+            putU32(&frameSequence, sequence++);
+            ok = ok && writeChunk(out, "fdAT", frameSequence, encoded[i].data(), encoded[i].size());
+        }
+    }
+
+    ok = ok && writeChunk(out, "IEND", std::vector<Uint8>());
+    ok = (fclose(out) == 0) && ok;
+
+    if (!ok) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s", path);
+    }
+    return ok;
+}
+
+bool TraceRenderer::render(const char* tracePath, const char* sheetPath, const char* outPath,
+                           int threads, unsigned int seed) {
+    // Random idle animations come from rand(); a fixed seed makes renders comparable
+    srand(seed);
+
+    if (!loadTrace(tracePath) || !loadSheet(sheetPath)) {
+        return false;
+    }
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    simulate();
+
+    // Frames are independent once simulated: composite and deflate contiguous chunks in parallel
+    size_t count = snapshots.size();
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    threads = std::max(1, std::min(threads, (int)count));
+
+    std::vector<std::vector<Uint8>> encoded(count);
+    std::vector<char> chunkOk(threads, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        size_t first = count * t / threads;
+        size_t last = count * (t + 1) / threads;
+        workers.emplace_back([this, first, last, t, &encoded, &chunkOk]() {
+            chunkOk[t] = encodeFrames(first, last, &encoded);
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if (std::find(chunkOk.begin(), chunkOk.end(), 0) != chunkOk.end()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to compress frames");
+        return false;
+    }
+    if (!writeApng(outPath, encoded)) {
+        return false;
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simulatedSeconds = ticks * (1000 / FPS) / 1000.0;
+    SDL_Log("Rendered %u ticks (%.1f s) into %d frame(s), %dx%d, on %d thread(s) in %.3f s (%.0fx real time)",
+            ticks, simulatedSeconds, (int)count, canvasW, canvasH, threads, wallSeconds,
+            wallSeconds > 0.0 ? simulatedSeconds / wallSeconds : 0.0);
+    return true;
+}
@@ -0,0 +1,477 @@
+#include "include/window_index.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+bool containsPoint(const WindowRect& r, double px, double py) {
+    return px >= r.x && px < r.x + r.w && py >= r.y && py < r.y + r.h;
+}
+
+// Liang-Barsky clip of the segment against the rectangle
+bool segmentCrossesRect(const WindowRect& r, double x0, double y0, double x1, double y1) {
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {x0 - r.x, r.x + r.w - x0, y0 - r.y, r.y + r.h - y0};
+    double t0 = 0.0;
+    double t1 = 1.0;
+
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;  // Parallel and outside
+            continue;
+        }
+        double t = q[i] / p[i];
+        if (p[i] < 0.0) {
+            if (t > t1) return false;
+            if (t > t0) t0 = t;
+        } else {
+            if (t < t0) return false;
+            if (t < t1) t1 = t;
+        }
+    }
+    return true;
+}
+
+bool isIndexable(const WindowRect& r, bool mapped) {
+    return mapped && r.w >= WINDOW_MIN_WIDTH && r.h >= WINDOW_MIN_HEIGHT;
+}
+
+bool containsRect(const WindowRect& outer, const WindowRect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+}  // namespace
+
+WindowIndex::WindowIndex(int cellSize) : cellSize(cellSize), display(nullptr), root(0) {
+}
+
+long long WindowIndex::cellKey(int cx, int cy) {
+    return ((long long)cx << 32) ^ (unsigned int)cy;
+}
+
+int WindowIndex::cellCoord(double v) const {
+    return (int)std::floor(v / cellSize);
+}
+
+void WindowIndex::indexEntry(Window w, Entry& entry) {
+    if (!isIndexable(entry.rect, entry.mapped)) {
+        return;
+    }
+
+    // Closed bounds: the segment clip counts a touch on the far edges as a hit
+    entry.cx0 = cellCoord(entry.rect.x);
+    entry.cy0 = cellCoord(entry.rect.y);
+    entry.cx1 = cellCoord(entry.rect.x + entry.rect.w);
+    entry.cy1 = cellCoord(entry.rect.y + entry.rect.h);
+
+    for (int cy = entry.cy0; cy <= entry.cy1; cy++) {
+        for (int cx = entry.cx0; cx <= entry.cx1; cx++) {
+            cells[cellKey(cx, cy)].push_back(w);
+        }
+    }
+    entry.indexed = true;
+}
+
+void WindowIndex::unindexEntry(Window w, Entry& entry) {
+    if (!entry.indexed) {
+        return;
+    }
+
+    for (int cy = entry.cy0; cy <= entry.cy1; cy++) {
+        for (int cx = entry.cx0; cx <= entry.cx1; cx++) {
+            auto it = cells.find(cellKey(cx, cy));
+            if (it == cells.end()) continue;
+
+            std::vector<Window>& list = it->second;
+            auto pos = std::find(list.begin(), list.end(), w);
+            if (pos != list.end()) {
+                *pos = list.back();
+                list.pop_back();
+            }
+            if (list.empty()) {
+                cells.erase(it);
+            }
+        }
+    }
+    entry.indexed = false;
+}
+
+void WindowIndex::setWindow(Window w, const WindowRect& rect, bool mapped) {
+    if (ignored.count(w)) {
+        return;
+    }
+
+    auto it = windows.find(w);
+    if (it == windows.end()) {
+        if (!stackDepth.count(w)) {
+            stackOnTop(w);  // Synthetic windows, or created before we looked
+        }
+        Entry entry = {rect, mapped, false, 0, 0, 0, 0};
+        indexEntry(w, windows.insert(std::make_pair(w, entry)).first->second);
+        return;
+    }
+
+    Entry& entry = it->second;
+
+    // Moves within the same cells (the common case while dragging) skip the re-index
+    if (entry.indexed && isIndexable(rect, mapped) &&
+        cellCoord(rect.x) == entry.cx0 && cellCoord(rect.y) == entry.cy0 &&
+        cellCoord(rect.x + rect.w) == entry.cx1 && cellCoord(rect.y + rect.h) == entry.cy1) {
+        entry.rect = rect;
+        return;
+    }
+
+    unindexEntry(w, entry);
+    entry.rect = rect;
+    entry.mapped = mapped;
+    indexEntry(w, entry);
+}
+
+void WindowIndex::removeWindow(Window w) {
+    unstack(w);
+
+    auto it = windows.find(w);
+    if (it == windows.end()) {
+        return;
+    }
+    unindexEntry(w, it->second);
+    windows.erase(it);
+}
+
+void WindowIndex::renumberStacking(size_t from) {
+    for (size_t i = from; i < stacking.size(); i++) {
+        stackDepth[stacking[i]] = (int)i;
+    }
+}
+
+void WindowIndex::stackOnTop(Window w) {
+    unstack(w);
+    stackDepth[w] = (int)stacking.size();
+    stacking.push_back(w);
+}
+
+void WindowIndex::unstack(Window w) {
+    auto it = stackDepth.find(w);
+    if (it == stackDepth.end()) {
+        return;
+    }
+    size_t depth = it->second;
+    stackDepth.erase(it);
+    stacking.erase(stacking.begin() + depth);
+    renumberStacking(depth);
+}
+
+void WindowIndex::restackWindow(Window w, Window above) {
+    auto self = stackDepth.find(w);
+    auto sibling = above ? stackDepth.find(above) : stackDepth.end();
+
+    // Most ConfigureNotify events are moves that leave the order alone
+    if (self != stackDepth.end() &&
+        ((above == None && self->second == 0) ||
+         (sibling != stackDepth.end() && self->second == sibling->second + 1))) {
+        return;
+    }
+    if (above != None && sibling == stackDepth.end()) {
+        stackOnTop(w);  // Sibling we never saw: the server just put w above something
+        return;
+    }
+
+    unstack(w);
+    size_t depth = above == None ? 0 : stackDepth[above] + 1;
+    stacking.insert(stacking.begin() + depth, w);
+    renumberStacking(depth);
+}
+
+bool WindowIndex::getWindow(Window w, WindowRect* rect) const {
+    auto it = windows.find(w);
+    if (it == windows.end() || !it->second.indexed) {
+        return false;
+    }
+    *rect = it->second.rect;
+    return true;
+}
+
+void WindowIndex::addFromAttributes(Window w) {
+    XWindowAttributes attrs;
+    if (!XGetWindowAttributes(display, w, &attrs) || attrs.override_redirect) {
+        return;
+    }
+
+    WindowRect rect = {
+        attrs.x,
+        attrs.y,
+        attrs.width + 2 * attrs.border_width,
+        attrs.height + 2 * attrs.border_width
+    };
+    setWindow(w, rect, attrs.map_state != IsUnmapped);
+}
+
+bool WindowIndex::init(Display* dpy) {
+    display = dpy;
+    root = DefaultRootWindow(display);
+
+    // Select before seeding so no change between the two is missed
+    XSelectInput(display, root, SubstructureNotifyMask);
+
+    Window rootReturn, parentReturn;
+    Window* children = nullptr;
+    unsigned int childCount = 0;
+    if (!XQueryTree(display, root, &rootReturn, &parentReturn, &children, &childCount)) {
+        return false;
+    }
+
+    // Children come bottom to top
+    for (unsigned int i = 0; i < childCount; i++) {
+        stackOnTop(children[i]);
+        addFromAttributes(children[i]);
+    }
+    if (children) {
+        XFree(children);
+    }
+
+    return true;
+}
+
+void WindowIndex::ignoreWindow(Window w) {
+    // Walk up to the top-level frame in case the window manager already reparented it
+    while (w && w != root) {
+        ignored.insert(w);
+        removeWindow(w);
+
+        if (!display) break;
+
+        Window rootReturn, parentReturn;
+        Window* children = nullptr;
+        unsigned int childCount = 0;
+        if (!XQueryTree(display, w, &rootReturn, &parentReturn, &children, &childCount)) {
+            break;
+        }
+        if (children) {
+            XFree(children);
+        }
+        w = parentReturn;
+    }
+}
+
+void WindowIndex::handleEvent(const XEvent& event) {
+    switch (event.type) {
+        case CreateNotify: {
+            const XCreateWindowEvent& e = event.xcreatewindow;
+            if (e.parent != root) break;
+
+            // New windows start on top; override-redirect ones only matter for stacking
+            stackOnTop(e.window);
+            if (e.override_redirect) break;
+
+            WindowRect rect = {e.x, e.y, e.width + 2 * e.border_width, e.height + 2 * e.border_width};
+            setWindow(e.window, rect, false);
+            break;
+        }
+        case DestroyNotify:
+            removeWindow(event.xdestroywindow.window);
+            break;
+        case MapNotify: {
+            auto it = windows.find(event.xmap.window);
+            if (it != windows.end()) {
+                setWindow(event.xmap.window, it->second.rect, true);
+            }
+            break;
+        }
+        case UnmapNotify: {
+            if (event.xunmap.event != root) break;
+
+            auto it = windows.find(event.xunmap.window);
+            if (it != windows.end()) {
+                setWindow(event.xunmap.window, it->second.rect, false);
+            }
+            break;
+        }
+        case ConfigureNotify: {
+            const XConfigureEvent& e = event.xconfigure;
+            if (e.event != root) break;
+
+            restackWindow(e.window, e.above);
+
+            auto it = windows.find(e.window);
+            if (it != windows.end()) {
+                WindowRect rect = {e.x, e.y, e.width + 2 * e.border_width, e.height + 2 * e.border_width};
+                setWindow(e.window, rect, it->second.mapped);
+            }
+            break;
+        }
+        case CirculateNotify: {
+            const XCirculateEvent& e = event.xcirculate;
+            if (e.event != root) break;
+
+            if (e.place == PlaceOnTop) {
+                stackOnTop(e.window);
+            } else {
+                restackWindow(e.window, None);
+            }
+            break;
+        }
+        case GravityNotify: {
+            const XGravityEvent& e = event.xgravity;
+            auto it = windows.find(e.window);
+            if (it != windows.end()) {
+                WindowRect rect = it->second.rect;
+                rect.x = e.x;
+                rect.y = e.y;
+                setWindow(e.window, rect, it->second.mapped);
+            }
+            break;
+        }
+        case ReparentNotify: {
+            const XReparentEvent& e = event.xreparent;
+            if (ignored.count(e.window)) {
+                // Our own window got a frame; the frame is not an obstacle either
+                ignored.insert(e.parent);
+                removeWindow(e.parent);
+            } else if (e.parent == root) {
+                stackOnTop(e.window);
+                addFromAttributes(e.window);
+            } else {
+                removeWindow(e.window);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool WindowIndex::nearestPerch(double px, double py, double maxDistance,
+                               double* perchX, double* perchY, Window* perchWindow) const {
+    double bestDist2 = maxDistance * maxDistance;
+    bool found = false;
+
+    int cx0 = cellCoord(px - maxDistance);
+    int cy0 = cellCoord(py - maxDistance);
+    int cx1 = cellCoord(px + maxDistance);
+    int cy1 = cellCoord(py + maxDistance);
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            auto cell = cells.find(cellKey(cx, cy));
+            if (cell == cells.end()) continue;
+
+            for (Window w : cell->second) {
+                const WindowRect& r = windows.find(w)->second.rect;
+
+                // Closest point on the top edge
+                double ex = std::min(std::max(px, (double)r.x), (double)(r.x + r.w - 1));
+                double dx = ex - px;
+                double dy = r.y - py;
+                double dist2 = dx * dx + dy * dy;
+
+                // The cat is always on top: on a buried edge it would sit over another window
+                if (dist2 <= bestDist2 && !coveredAt(w, ex, r.y)) {
+                    bestDist2 = dist2;
+                    *perchX = ex;
+                    *perchY = r.y;
+                    *perchWindow = w;
+                    found = true;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+bool WindowIndex::coveredAt(Window w, double px, double py) const {
+    // Any window containing the point is listed in the point's cell
+    auto cell = cells.find(cellKey(cellCoord(px), cellCoord(py)));
+    if (cell == cells.end()) {
+        return false;
+    }
+
+    int depth = depthOf(w);
+    for (Window other : cell->second) {
+        if (depthOf(other) > depth && containsPoint(windows.find(other)->second.rect, px, py)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WindowIndex::hiddenBy(Window w, const WindowRect& r, const std::vector<Window>& neighbours) const {
+    // A window covering all of w overlaps every cell w is in, this one included
+    int depth = depthOf(w);
+    for (Window other : neighbours) {
+        if (depthOf(other) > depth && containsRect(windows.find(other)->second.rect, r)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WindowIndex::segmentHitsCell(int cx, int cy, double x0, double y0, double x1, double y1,
+                                  double goalX, double goalY) const {
+    auto cell = cells.find(cellKey(cx, cy));
+    if (cell == cells.end()) {
+        return false;
+    }
+
+    for (Window w : cell->second) {
+        const WindowRect& r = windows.find(w)->second.rect;
+        if (containsPoint(r, x0, y0) || containsPoint(r, goalX, goalY)) {
+            continue;
+        }
+        if (segmentCrossesRect(r, x0, y0, x1, y1) && !hiddenBy(w, r, cell->second)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WindowIndex::segmentIntersects(double x0, double y0, double x1, double y1,
+                                    double goalX, double goalY) const {
+    // Walk only the grid cells the segment passes through (Amanatides-Woo)
+    int cx = cellCoord(x0);
+    int cy = cellCoord(y0);
+    int endX = cellCoord(x1);
+    int endY = cellCoord(y1);
+
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    int stepX = (dx > 0) ? 1 : -1;
+    int stepY = (dy > 0) ? 1 : -1;
+
+    double tMaxX = HUGE_VAL, tDeltaX = HUGE_VAL;
+    double tMaxY = HUGE_VAL, tDeltaY = HUGE_VAL;
+    if (dx != 0.0) {
+        double boundary = (double)(stepX > 0 ? cx + 1 : cx) * cellSize;
+        tMaxX = (boundary - x0) / dx;
+        tDeltaX = cellSize / std::fabs(dx);
+    }
+    if (dy != 0.0) {
+        double boundary = (double)(stepY > 0 ? cy + 1 : cy) * cellSize;
+        tMaxY = (boundary - y0) / dy;
+        tDeltaY = cellSize / std::fabs(dy);
+    }
+
+    for (;;) {
+        if (segmentHitsCell(cx, cy, x0, y0, x1, y1, goalX, goalY)) {
+            return true;
+        }
+        if (cx == endX && cy == endY) {
+            break;
+        }
+
+        if (tMaxX < tMaxY) {
+            if (tMaxX > 1.0) break;
+            cx += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            if (tMaxY > 1.0) break;
+            cy += stepY;
+            tMaxY += tDeltaY;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,54 @@
+#!/bin/sh
+# CPU and resident memory of one daemon serving 1, 2, 4 and 8 Xvfb displays,
+# plus the CPU of those X servers. Nothing moves the pointers, so the cats
+# sit and groom; this is the cost of idle displays.
+. "$(dirname "$0")/xvfb.sh"
+require_xvfb
+
+MEASURE=10  # Seconds per run
+SETTLE=2    # Seconds for attaching and the first draws
+FIRST=100   # Displays :100 to :107
+
+RUNTIME=$(mktemp -d)
+trap 'kill $DAEMON 2>/dev/null; stop_xvfbs; rm -rf "$RUNTIME"' EXIT
+export XDG_RUNTIME_DIR="$RUNTIME"  # Own control socket and sheet cache
+HZ=$(getconf CLK_TCK)
+
+SERVERS=""
+for i in 0 1 2 3 4 5 6 7; do
+    start_xvfb $((FIRST + i)) || exit 1
+    SERVERS="$SERVERS $XVFB_PID"
+done
+
+server_ticks() {
+    total=0
+    for pid in $(echo $SERVERS | cut -d' ' -f1-$1); do
+        total=$((total + $(cpu_ticks $pid)))
+    done
+    echo $total
+}
+
+printf "%8s %12s %12s %10s\n" displays "daemon %cpu" "servers %cpu" "rss KiB"
+for n in 1 2 4 8; do
+    DISPLAYS=""
+    for i in $(seq 0 $((n - 1))); do
+        DISPLAYS="$DISPLAYS :$((FIRST + i))"
+    done
+
+    ./mousecat --daemon $DISPLAYS >/dev/null 2>&1 &
+    DAEMON=$!
+    sleep $SETTLE
+
+    daemon0=$(cpu_ticks $DAEMON)
+    server0=$(server_ticks $n)
+    sleep $MEASURE
+    daemon1=$(cpu_ticks $DAEMON)
+    server1=$(server_ticks $n)
+    rss=$(awk '/^VmRSS/ { print $2 }' "/proc/$DAEMON/status")
+
+    kill $DAEMON
+    wait $DAEMON 2>/dev/null
+
+    awk -v n=$n -v d=$((daemon1 - daemon0)) -v s=$((server1 - server0)) -v hz=$HZ -v t=$MEASURE -v rss=$rss \
+        'BEGIN { printf "%8d %12.2f %12.2f %10d\n", n, 100 * d / hz / t, 100 * s / hz / t, rss }'
+done
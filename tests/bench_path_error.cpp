@@ -0,0 +1,123 @@
+// Replays a cursor trace through CatBehavior at several tick rates, with and
+// without cursor prediction, and reports how far the cat strays from the
+// path it takes when ticked every millisecond. Takes a trace file in the
+// --render format, or generates a reproducible one.
+#include "include/cat_behavior.h"
+#include "include/trace_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const Uint32 TRACE_MS = 120000;        // Length of the generated trace
+const Uint32 SAMPLE_MS = 8;            // 125 Hz, a common mouse report rate
+const Uint32 PAUSE_EVERY_MS = 10000;   // Every third stretch of this the hand rests
+const double START_OFFSET = 200.0;     // Cat starts this far right of the cursor
+
+std::vector<TraceSample> generateTrace() {
+    std::vector<TraceSample> trace;
+    double t = 0;  // Motion time, stands still during pauses
+    for (Uint32 now = 0; now <= TRACE_MS; now += SAMPLE_MS) {
+        if ((now / PAUSE_EVERY_MS) % 3 != 2) {
+            t += SAMPLE_MS / 1000.0;
+        }
+        TraceSample s;
+        s.timeMs = now;
+        s.x = (int)(960 + 200 * sin(2 * M_PI * t / 23) + 60 * sin(2 * M_PI * t / 7));
+        s.y = (int)(540 + 150 * sin(2 * M_PI * t / 19) + 40 * cos(2 * M_PI * t / 5));
+        trace.push_back(s);
+    }
+    return trace;
+}
+
+bool loadTrace(const char* path, std::vector<TraceSample>* trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Cannot open %s\n", path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        unsigned int timeMs;
+        int x, y;
+        if (line[0] != '#' && sscanf(line, "%u %d %d", &timeMs, &x, &y) == 3) {
+            TraceSample s = {(Uint32)timeMs, x, y};
+            trace->push_back(s);
+        }
+    }
+    fclose(file);
+    return !trace->empty();
+}
+
+// Latest sample at or before now, as polling the pointer would see it
+const TraceSample& sampleAt(const std::vector<TraceSample>& trace, Uint32 now, size_t* next) {
+    while (*next + 1 < trace.size() && trace[*next + 1].timeMs <= now) {
+        (*next)++;
+    }
+    return trace[*next];
+}
+
+// Cat position at every millisecond of the trace, or at every tick held until the next
+std::vector<double> run(const FrameDesc* table, const std::vector<TraceSample>& trace,
+                        Uint32 tickMs, bool prediction) {
+    srand(1);
+    Uint32 start = trace.front().timeMs;
+    Uint32 end = trace.back().timeMs;
+    CatBehavior cat(table, nullptr, trace[0].x + START_OFFSET, trace[0].y, trace[0].x, trace[0].y, start);
+    cat.setPrediction(prediction);
+
+    std::vector<double> path(2 * (end - start + 1));
+    size_t next = 0;
+    for (Uint32 now = start; now <= end; now += tickMs) {
+        const TraceSample& s = sampleAt(trace, now, &next);
+        cat.update(s.x, s.y, now);
+        for (Uint32 t = now; t < now + tickMs && t <= end; t++) {
+            path[2 * (t - start)] = cat.getX();
+            path[2 * (t - start) + 1] = cat.getY();
+        }
+    }
+    return path;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<TraceSample> trace;
+    if (argc > 1) {
+        if (!loadTrace(argv[1], &trace)) {
+            return 1;
+        }
+    } else {
+        trace = generateTrace();
+    }
+
+    FrameDesc table[FRAME_TABLE_SIZE];
+    fillFrameTable(table, 32);
+
+    std::vector<double> reference = run(table, trace, 1, false);
+
+    // Error is taken at each tick, where the cat is placed; between ticks it is held
+    const int rates[] = {10, 15, 30};
+    printf("%4s %11s %10s %10s\n", "FPS", "prediction", "mean px", "max px");
+    for (int fps : rates) {
+        Uint32 tickMs = 1000 / fps;
+        for (int prediction = 0; prediction < 2; prediction++) {
+            std::vector<double> path = run(table, trace, tickMs, prediction != 0);
+            double total = 0, worst = 0;
+            size_t ticks = 0;
+            for (size_t t = 0; 2 * t < path.size(); t += tickMs) {
+                double dx = path[2 * t] - reference[2 * t];
+                double dy = path[2 * t + 1] - reference[2 * t + 1];
+                double error = sqrt(dx * dx + dy * dy);
+                total += error;
+                worst = std::max(worst, error);
+                ticks++;
+            }
+            printf("%4d %11s %10.2f %10.2f\n", fps, prediction ? "on" : "off", total / ticks, worst);
+        }
+    }
+    return 0;
+}
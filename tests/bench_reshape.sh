@@ -0,0 +1,9 @@
+#!/bin/sh
+# X server CPU per window reshape under Xvfb: the old 1-bit mask against
+# rectangle lists and pre-built XFixes regions.
+. "$(dirname "$0")/xvfb.sh"
+require_xvfb
+trap stop_xvfbs EXIT
+
+start_xvfb 91 || exit 1
+DISPLAY=:91 XSERVER_PID=$XVFB_PID build/probe_reshape "$@"
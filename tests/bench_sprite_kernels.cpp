@@ -0,0 +1,85 @@
+// Per-cell cost of the size-specialized packShape and blend kernels against
+// the per-pixel loops they replaced, on sprite-like cells and on noise.
+#include "sprite_reference.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+const int CELLS = 256;    // Distinct cells, cycled through
+const int PASSES = 200;   // Times each cell is processed per measurement
+
+volatile long sink;  // Keeps the results from being optimized away
+
+double nsPerCell(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / ((double)CELLS * PASSES);
+}
+
+}  // namespace
+
+int main() {
+    const int sizes[] = {16, 32, 48, 64};
+    const char* const kinds[] = {"sprite", "noise"};
+
+    printf("%4s %7s %15s %15s %15s %15s\n", "size", "cells",
+           "old shape ns", "packShape ns", "old blend ns", "blend ns");
+    for (int size : sizes) {
+        const SpriteKernels* kernels = spriteKernelsFor(size);
+        int pitch = SHEET_COLUMNS * size * 4;
+
+        for (int kind = 0; kind < 2; kind++) {
+            srand(size);
+            std::vector<std::vector<Uint8>> cells(CELLS, std::vector<Uint8>(pitch * size));
+            for (std::vector<Uint8>& cell : cells) {
+                if (kind == 0) {
+                    spriteCell(cell.data(), pitch, size);
+                } else {
+                    noiseCell(cell.data(), pitch, size);
+                }
+            }
+            std::vector<Uint8> canvas(pitch * size, 0x80);
+            std::vector<XRectangle> rects;
+            double ns[4];
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < PASSES; pass++) {
+                for (const std::vector<Uint8>& cell : cells) {
+                    referencePackShape(cell.data(), pitch, size, &rects);
+                    sink += rects.size();
+                }
+            }
+            ns[0] = nsPerCell(start);
+
+            start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < PASSES; pass++) {
+                for (const std::vector<Uint8>& cell : cells) {
+                    kernels->packShape(cell.data(), pitch, &rects);
+                    sink += rects.size();
+                }
+            }
+            ns[1] = nsPerCell(start);
+
+            start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < PASSES; pass++) {
+                for (const std::vector<Uint8>& cell : cells) {
+                    referenceBlend(cell.data(), pitch, size, canvas.data(), pitch);
+                }
+            }
+            sink += canvas[pitch / 2];
+            ns[2] = nsPerCell(start);
+
+            start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < PASSES; pass++) {
+                for (const std::vector<Uint8>& cell : cells) {
+                    kernels->blend(cell.data(), pitch, canvas.data(), pitch);
+                }
+            }
+            sink += canvas[pitch / 2];
+            ns[3] = nsPerCell(start);
+
+            printf("%4d %7s %15.1f %15.1f %15.1f %15.1f\n", size, kinds[kind], ns[0], ns[1], ns[2], ns[3]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Per-query cost of WindowIndex against the linear scan it replaced, with
+// thousands of synthetic windows and chase-sized queries.
+#include "window_scan.h"
+#include "include/cat_behavior.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const int DESKTOP_W = 7680;  // A wall of four 4K monitors
+const int DESKTOP_H = 4320;
+const int QUERIES = 200000;
+
+volatile long sink;  // Keeps the queries from being optimized away
+
+struct Query {
+    double x0, y0, x1, y1, goalX, goalY;
+};
+
+double nsPerQuery(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / QUERIES;
+}
+
+}  // namespace
+
+int main() {
+    const int windowCounts[] = {1000, 5000, 20000};
+    const int cellSizes[] = {64, 128, 256, 512, 1024};
+
+    std::vector<Query> queries(QUERIES);
+    srand(1);
+    for (Query& q : queries) {
+        double angle = (rand() % 3600) * M_PI / 1800.0;
+        q.x0 = rand() % DESKTOP_W;
+        q.y0 = rand() % DESKTOP_H;
+        q.x1 = q.x0 + cos(angle) * OBSTACLE_LOOKAHEAD;
+        q.y1 = q.y0 + sin(angle) * OBSTACLE_LOOKAHEAD;
+        q.goalX = rand() % DESKTOP_W;
+        q.goalY = rand() % DESKTOP_H;
+    }
+
+    printf("%8s %8s %14s %14s\n", "windows", "cell", "segment ns", "perch ns");
+    for (int count : windowCounts) {
+        srand(count);
+        std::vector<WindowRect> rects;
+        for (int i = 0; i < count; i++) {
+            rects.push_back(randomWindow(DESKTOP_W, DESKTOP_H));
+        }
+
+        long hits = 0;
+        WindowScan scan;
+        for (int i = 0; i < count; i++) {
+            scan.add(i + 1, rects[i]);
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (const Query& q : queries) {
+            hits += scan.segmentIntersects(q.x0, q.y0, q.x1, q.y1, q.goalX, q.goalY);
+        }
+        double segmentNs = nsPerQuery(start);
+        start = std::chrono::steady_clock::now();
+        for (const Query& q : queries) {
+            hits += scan.nearestPerch(q.x0, q.y0, PERCH_SNAP_DISTANCE) >= 0;
+        }
+        printf("%8d %8s %14.1f %14.1f\n", count, "linear", segmentNs, nsPerQuery(start));
+
+        for (int cellSize : cellSizes) {
+            WindowIndex index(cellSize);
+            for (int i = 0; i < count; i++) {
+                index.setWindow(i + 1, rects[i], true);
+            }
+
+            start = std::chrono::steady_clock::now();
+            for (const Query& q : queries) {
+                hits += index.segmentIntersects(q.x0, q.y0, q.x1, q.y1, q.goalX, q.goalY);
+            }
+            segmentNs = nsPerQuery(start);
+            start = std::chrono::steady_clock::now();
+            for (const Query& q : queries) {
+                double px, py;
+                Window w;
+                hits += index.nearestPerch(q.x0, q.y0, PERCH_SNAP_DISTANCE, &px, &py, &w);
+            }
+            printf("%8d %8d %14.1f %14.1f\n", count, cellSize, segmentNs, nsPerQuery(start));
+        }
+        sink = hits;
+    }
+    return 0;
+}
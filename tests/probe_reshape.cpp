@@ -0,0 +1,145 @@
+// Reshapes a window through the running cat's cells with each shaping
+// method and reports wall, client CPU and (with XSERVER_PID) X server CPU
+// per reshape. Driven by bench_reshape.sh under Xvfb.
+#include "include/frame_table.h"
+#include "include/sprite_kernels.h"
+#include <SDL2/SDL_image.h>
+#include <X11/extensions/shape.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+
+const int RESHAPES = 20000;
+
+double processCpuUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// utime + stime of the X server in microseconds, -1 when unknown
+double serverCpuUs() {
+    const char* pid = getenv("XSERVER_PID");
+    if (!pid) return -1;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%s/stat", pid);
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+
+    // Fields 14 and 15; the command name in field 2 has no spaces for Xvfb
+    unsigned long utime = 0, stime = 0;
+    int matched = fscanf(file, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime);
+    fclose(file);
+    return matched == 2 ? (utime + stime) * 1e6 / sysconf(_SC_CLK_TCK) : -1;
+}
+
+// 1-bit mask of one cell, as the shaping code built before regions
+Pixmap cellBitmap(Display* dpy, Window window, const SDL_Surface* sheet, const SDL_Rect& src) {
+    int bytesPerRow = (src.w + 7) / 8;
+    std::vector<char> bits(bytesPerRow * src.h, 0);
+    for (int y = 0; y < src.h; y++) {
+        const Uint8* row = (const Uint8*)sheet->pixels + (src.y + y) * sheet->pitch + src.x * 4;
+        for (int x = 0; x < src.w; x++) {
+            if (row[x * 4 + 3] > SHAPE_ALPHA_THRESHOLD) {
+                bits[y * bytesPerRow + x / 8] |= 1 << (x % 8);
+            }
+        }
+    }
+    return XCreateBitmapFromData(dpy, window, bits.data(), src.w, src.h);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const char* sheetPath = argc > 1 ? argv[1] : "src/sprite/oneko-W.png";
+
+    Display* dpy = XOpenDisplay(nullptr);
+    if (!dpy) {
+        printf("No X display, skipping\n");
+        return 77;
+    }
+    int eventBase, errorBase;
+    if (!XFixesQueryExtension(dpy, &eventBase, &errorBase)) {
+        printf("No XFixes, skipping\n");
+        return 77;
+    }
+
+    SDL_Surface* loaded = IMG_Load(sheetPath);
+    SDL_Surface* sheet = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    if (!sheet) {
+        printf("Cannot load %s\n", sheetPath);
+        return 1;
+    }
+    int size = detectFrameSize(sheet->w, sheet->h);
+    const SpriteKernels* kernels = spriteKernelsFor(size);
+    if (!kernels) {
+        printf("Unsupported sheet %s\n", sheetPath);
+        return 1;
+    }
+
+    XSetWindowAttributes attrs;
+    attrs.override_redirect = True;
+    Window window = XCreateWindow(dpy, DefaultRootWindow(dpy), 100, 100, size, size, 0, CopyFromParent,
+                                  InputOutput, CopyFromParent, CWOverrideRedirect, &attrs);
+    XMapWindow(dpy, window);
+
+    // The cells a chase flips through: every running frame in every direction
+    FrameDesc table[FRAME_TABLE_SIZE];
+    fillFrameTable(table, size);
+    std::vector<Pixmap> bitmaps;
+    std::vector<std::vector<XRectangle>> rects;
+    std::vector<XserverRegion> regions;
+    for (int d = 0; d < DIRECTION_COUNT; d++) {
+        for (int f = 0; f < ANIMATIONS[RUNNING].frameCount; f++) {
+            const SDL_Rect& src = table[frameIndex(RUNNING, (Direction)d, f)].src;
+            bitmaps.push_back(cellBitmap(dpy, window, sheet, src));
+
+            rects.push_back(std::vector<XRectangle>());
+            kernels->packShape((const Uint8*)sheet->pixels + src.y * sheet->pitch + src.x * 4,
+                               sheet->pitch, &rects.back());
+            regions.push_back(XFixesCreateRegion(dpy, rects.back().data(), (int)rects.back().size()));
+        }
+    }
+    XSync(dpy, False);
+
+    const char* methods[] = {"XShapeCombineMask", "XShapeCombineRectangles", "XFixesSetWindowShapeRegion"};
+    printf("%-28s %10s %12s %12s\n", "method", "wall us", "client us", "server us");
+    for (int m = 0; m < 3; m++) {
+        double server0 = serverCpuUs();
+        double client0 = processCpuUs();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < RESHAPES; i++) {
+            size_t cell = i % regions.size();
+            if (m == 0) {
+                XShapeCombineMask(dpy, window, ShapeBounding, 0, 0, bitmaps[cell], ShapeSet);
+            } else if (m == 1) {
+                XShapeCombineRectangles(dpy, window, ShapeBounding, 0, 0, rects[cell].data(),
+                                        (int)rects[cell].size(), ShapeSet, YXBanded);
+            } else {
+                XFixesSetWindowShapeRegion(dpy, window, ShapeBounding, 0, 0, regions[cell]);
+            }
+        }
+        XSync(dpy, False);
+
+        std::chrono::duration<double, std::micro> wall = std::chrono::steady_clock::now() - start;
+        double client = processCpuUs() - client0;
+        double server = server0 < 0 ? -1 : serverCpuUs() - server0;
+        if (server < 0) {
+            printf("%-28s %10.2f %12.2f %12s\n", methods[m], wall.count() / RESHAPES, client / RESHAPES, "n/a");
+        } else {
+            printf("%-28s %10.2f %12.2f %12.2f\n", methods[m], wall.count() / RESHAPES,
+                   client / RESHAPES, server / RESHAPES);
+        }
+    }
+
+    XCloseDisplay(dpy);
+    SDL_FreeSurface(sheet);
+    SDL_FreeSurface(loaded);
+    return 0;
+}
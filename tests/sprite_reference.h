@@ -0,0 +1,92 @@
+#ifndef SPRITE_REFERENCE_H
+#define SPRITE_REFERENCE_H
+
+#include "include/sprite_kernels.h"
+#include <cstdlib>
+#include <vector>
+
+// Reference for SpriteKernels: the per-pixel loops they replaced, with the
+// cell size as a runtime value. Alpha is read directly rather than through
+// SDL_GetRGBA as the old shape loop did, so its timings flatter the old code.
+// Shared by the sprite kernel test and benchmark.
+
+// Run-length encodes each row, then merges rows whose runs match the band above
+inline void referencePackShape(const Uint8* cell, int pitch, int size, std::vector<XRectangle>* rects) {
+    rects->clear();
+    std::vector<XRectangle> rowRuns;
+    size_t bandStart = 0;
+    size_t bandCount = 0;
+
+    for (int y = 0; y < size; y++) {
+        rowRuns.clear();
+
+        int runStart = -1;
+        for (int x = 0; x <= size; x++) {
+            bool opaque = x < size && cell[y * pitch + x * 4 + 3] > SHAPE_ALPHA_THRESHOLD;
+            if (opaque && runStart < 0) {
+                runStart = x;
+            } else if (!opaque && runStart >= 0) {
+                XRectangle run = {(short)runStart, (short)y, (unsigned short)(x - runStart), 1};
+                rowRuns.push_back(run);
+                runStart = -1;
+            }
+        }
+
+        bool sameAsBand = rowRuns.size() == bandCount;
+        for (size_t i = 0; sameAsBand && i < bandCount; i++) {
+            const XRectangle& prev = (*rects)[bandStart + i];
+            sameAsBand = prev.x == rowRuns[i].x && prev.width == rowRuns[i].width;
+        }
+
+        if (sameAsBand) {
+            for (size_t i = 0; i < bandCount; i++) {
+                (*rects)[bandStart + i].height++;
+            }
+        } else {
+            bandStart = rects->size();
+            bandCount = rowRuns.size();
+            rects->insert(rects->end(), rowRuns.begin(), rowRuns.end());
+        }
+    }
+}
+
+inline void referenceBlend(const Uint8* cell, int pitch, int size, Uint8* dst, int dstPitch) {
+    for (int sy = 0; sy < size; sy++) {
+        for (int sx = 0; sx < size; sx++) {
+            const Uint8* src = cell + sy * pitch + sx * 4;
+            Uint8* out = dst + sy * dstPitch + sx * 4;
+            int alpha = src[3];
+            for (int c = 0; c < 3; c++) {
+                out[c] = (Uint8)((src[c] * alpha + out[c] * (255 - alpha) + 127) / 255);
+            }
+        }
+    }
+}
+
+// Sprite-like cell: an opaque blob with a soft edge on a transparent background
+inline void spriteCell(Uint8* cell, int pitch, int size) {
+    double cx = size * (0.3 + 0.4 * rand() / RAND_MAX);
+    double cy = size * (0.3 + 0.4 * rand() / RAND_MAX);
+    double r2 = size * size * (0.05 + 0.15 * rand() / RAND_MAX);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            Uint8* p = cell + y * pitch + x * 4;
+            double d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+            p[0] = (Uint8)rand();
+            p[1] = (Uint8)rand();
+            p[2] = (Uint8)rand();
+            p[3] = d2 < r2 ? 255 : d2 < r2 * 1.3 ? (Uint8)(255 * (r2 * 1.3 - d2) / (r2 * 0.3)) : 0;
+        }
+    }
+}
+
+// Every pixel random, alpha included: many short runs and no repeated rows
+inline void noiseCell(Uint8* cell, int pitch, int size) {
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size * 4; x++) {
+            cell[y * pitch + x] = (Uint8)rand();
+        }
+    }
+}
+
+#endif // SPRITE_REFERENCE_H
@@ -0,0 +1,106 @@
+// Idle, tired and animation-switch timers run on elapsed time: falling
+// asleep, waking up and how long animations last come out the same at
+// every tick rate.
+#include "include/cat_behavior.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int CAT_X = 500;
+const int CAT_Y = 500;
+const Uint32 START_MS = 1000;
+const Uint32 JIGGLE_MS = 20000;          // Nudges the cursor so the cat stays awake
+const Uint32 GROOMING_RUN_MS = 4 * 3600 * 1000;
+const double GROOMING_TOLERANCE = 0.05;  // Allowed spread in mean animation length
+
+int failures = 0;
+
+void expectNear(const char* what, int fps, Uint32 got, Uint32 want, Uint32 tolerance) {
+    if (got + tolerance < want || got > want + tolerance) {
+        printf("FAIL %s at %d FPS: %u ms, expected %u +- %u\n", what, fps, got, want, tolerance);
+        failures++;
+    }
+}
+
+// Time from the last cursor move to SLEEPING, then from the wake-up move to IDLE
+void checkSleepAndWake(const FrameDesc* table, int fps) {
+    Uint32 tickMs = 1000 / fps;
+    CatBehavior cat(table, nullptr, CAT_X, CAT_Y, CAT_X, CAT_Y, START_MS);
+
+    Uint32 now = START_MS;
+    while (cat.getState() != SLEEPING && now < START_MS + 60000) {
+        now += tickMs;
+        cat.update(CAT_X, CAT_Y, now);
+    }
+    // Two timers in a row, each rounded up to a whole tick
+    expectNear("asleep after", fps, now - START_MS, MOUSE_IDLE_SLEEP_TIME_MS + TIRED_DELAY_MS, 2 * tickMs);
+
+    Uint32 woken = now + tickMs;
+    cat.update(CAT_X + 1, CAT_Y, woken);
+    now = woken;
+    while (cat.getState() == WAKING_UP && now < woken + 10000) {
+        now += tickMs;
+        cat.update(CAT_X + 1, CAT_Y, now);
+    }
+    expectNear("awake after", fps, now - woken, TIRED_DELAY_MS, tickMs);
+}
+
+// Mean length of scratching, itching and paw-up stints over a long idle stretch
+double meanGroomingMs(const FrameDesc* table, int fps) {
+    Uint32 tickMs = 1000 / fps;
+    srand(1);
+    CatBehavior cat(table, nullptr, CAT_X, CAT_Y, CAT_X, CAT_Y, START_MS);
+
+    double total = 0;
+    int stints = 0;
+    CatState last = IDLE;
+    Uint32 since = START_MS;
+    for (Uint32 now = START_MS + tickMs; now < START_MS + GROOMING_RUN_MS; now += tickMs) {
+        int jiggle = (now / JIGGLE_MS) % 2;
+        cat.update(CAT_X + jiggle, CAT_Y, now);
+
+        CatState state = cat.getState();
+        if (state != last) {
+            if (last == SCRATCHING || last == ITCHING || last == PAWUP) {
+                total += now - since;
+                stints++;
+            }
+            last = state;
+            since = now;
+        }
+    }
+    return stints ? total / stints : 0;
+}
+
+}  // namespace
+
+int main() {
+    FrameDesc table[FRAME_TABLE_SIZE];
+    fillFrameTable(table, 32);
+
+    const int rates[] = {5, 10, 15, 30, 60};
+    double grooming[sizeof(rates) / sizeof(rates[0])];
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        checkSleepAndWake(table, rates[i]);
+        grooming[i] = meanGroomingMs(table, rates[i]);
+        printf("%2d FPS: animations last %.0f ms on average\n", rates[i], grooming[i]);
+    }
+
+    // Against the nominal rate; the minimum play time alone is 3000 ms of it
+    double nominal = grooming[2];
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (fabs(grooming[i] - nominal) > nominal * GROOMING_TOLERANCE) {
+            printf("FAIL animations at %d FPS last %.0f ms, %.0f ms at %d FPS\n",
+                   rates[i], grooming[i], nominal, FPS);
+            failures++;
+        }
+    }
+
+    if (failures) {
+        return 1;
+    }
+    printf("behavior timers: OK\n");
+    return 0;
+}
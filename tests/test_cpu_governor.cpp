@@ -0,0 +1,102 @@
+// The governor steps fidelity down under a load over budget, stops where the
+// load fits, comes back once idle and tightens the budget on battery. Real
+// CPU time is burnt against a simulated wall clock, with a stand-in AC file.
+#include "include/cpu_governor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+
+const double BUDGET_PERCENT = 1.0;  // 10 ms of CPU per simulated second
+const Uint32 TICK_MS = 100;
+
+Uint32 now;
+int failures = 0;
+
+void burnUs(long us) {
+    struct timespec start, t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
+    do {
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    } while ((t.tv_sec - start.tv_sec) * 1000000L + (t.tv_nsec - start.tv_nsec) / 1000 < us);
+}
+
+void writeAc(const char* path, const char* state) {
+    FILE* file = fopen(path, "w");
+    fputs(state, file);
+    fclose(file);
+}
+
+// CPU per simulated second at full fidelity; coarse halves the cost of a
+// tick, the rate levels stretch the tick
+void run(CpuGovernor* governor, int seconds, long fullCostUs) {
+    Uint32 end = now + seconds * 1000;
+    while ((Sint32)(end - now) > 0) {
+        long cost = fullCostUs * TICK_MS / 1000;
+        if (governor->fidelity() >= FIDELITY_COARSE) {
+            cost /= 2;
+        }
+        burnUs(cost);
+        now += TICK_MS * governor->tickDivisor();
+        governor->sample(now);
+    }
+}
+
+void expectLevel(const CpuGovernor& governor, Fidelity want, const char* phase) {
+    if (governor.fidelity() != want) {
+        printf("FAIL %s: fidelity %d, expected %d\n", phase, governor.fidelity(), want);
+        failures++;
+    }
+}
+
+}  // namespace
+
+int main() {
+    char acPath[] = "/tmp/mousecat-ac-XXXXXX";
+    int fd = mkstemp(acPath);
+    if (fd < 0) {
+        printf("Cannot create the AC file\n");
+        return 1;
+    }
+    close(fd);
+    writeAc(acPath, "1\n");
+
+    // The simulated clock starts where enable() reads the real one
+    CpuGovernor governor;
+    now = SDL_GetTicks();
+    governor.enable(BUDGET_PERCENT, acPath);
+
+    // 3% at full, 1.5% coarse and frozen, 0.75% at half rate: settles at half rate
+    run(&governor, 40, 30000);
+    expectLevel(governor, FIDELITY_HALF_RATE, "over budget");
+    if (governor.counted(GOVERNOR_STEP_DOWN) != 3 || governor.counted(GOVERNOR_STEP_UP) != 0) {
+        printf("FAIL over budget: %llu steps down, %llu up\n",
+               governor.counted(GOVERNOR_STEP_DOWN), governor.counted(GOVERNOR_STEP_UP));
+        failures++;
+    }
+
+    // Idle: a level back per full window
+    run(&governor, 60, 0);
+    expectLevel(governor, FIDELITY_FULL, "idle");
+
+    // 0.7% fits on AC but not in the halved battery budget
+    run(&governor, 20, 7000);
+    expectLevel(governor, FIDELITY_FULL, "on AC");
+    writeAc(acPath, "0\n");
+    run(&governor, 40, 7000);
+    if (governor.fidelity() == FIDELITY_FULL || governor.counted(GOVERNOR_ON_BATTERY) != 1) {
+        printf("FAIL on battery: fidelity %d, %llu battery switches\n",
+               governor.fidelity(), governor.counted(GOVERNOR_ON_BATTERY));
+        failures++;
+    }
+
+    unlink(acPath);
+    governor.report();
+    if (failures) {
+        return 1;
+    }
+    printf("cpu governor: OK\n");
+    return 0;
+}
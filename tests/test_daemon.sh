@@ -0,0 +1,24 @@
+#!/bin/sh
+# The daemon exits with an error instead of waiting forever when it has no
+# display and no control socket through which to be given one.
+if command -v timeout >/dev/null 2>&1; then
+    WAIT="timeout 10"
+else
+    WAIT=""
+fi
+
+# No runtime directory means no control socket; :9999 doesn't exist
+env -u XDG_RUNTIME_DIR $WAIT ./mousecat --daemon >/dev/null 2>&1
+RC=$?
+env -u XDG_RUNTIME_DIR $WAIT ./mousecat --daemon :9999 >/dev/null 2>&1
+RC_BAD=$?
+
+if [ $RC -eq 124 ] || [ $RC_BAD -eq 124 ]; then
+    echo "FAIL: daemon with nothing to serve kept running"
+    exit 1
+fi
+if [ $RC -eq 0 ] || [ $RC_BAD -eq 0 ]; then
+    echo "FAIL: daemon with nothing to serve exited successfully"
+    exit 1
+fi
+echo "daemon: OK"
@@ -0,0 +1,39 @@
+// Every (state, direction, frame) entry lands on a cell of the sheet, for
+// every supported frame size. Table order is checked at compile time.
+#include "include/frame_table.h"
+#include "include/sprite_kernels.h"
+#include <cstdio>
+
+int main() {
+    const int sizes[] = {16, 32, 48, 64};
+    int failures = 0;
+
+    for (int size : sizes) {
+        FrameDesc table[FRAME_TABLE_SIZE];
+        fillFrameTable(table, size);
+
+        for (int s = 0; s < CAT_STATE_COUNT; s++) {
+            for (int d = 0; d < DIRECTION_COUNT; d++) {
+                const FrameDesc& first = table[frameIndex((CatState)s, (Direction)d, 0)];
+                for (int f = 0; f < MAX_ANIM_FRAMES; f++) {
+                    const FrameDesc& e = table[frameIndex((CatState)s, (Direction)d, f)];
+                    bool inSheet = e.src.x >= 0 && e.src.y >= 0 && e.src.w == size && e.src.h == size &&
+                                   e.src.x + size <= SHEET_COLUMNS * size && e.src.y + size <= SHEET_ROWS * size;
+                    bool consistent = e.frameCount == ANIMATIONS[s].frameCount &&
+                                      e.durationMs == ANIMATIONS[s].frameDurationMs;
+                    bool padded = f < e.frameCount || (e.src.x == first.src.x && e.src.y == first.src.y);
+                    if (!inSheet || !consistent || !padded) {
+                        printf("FAIL size %d state %d direction %d frame %d\n", size, s, d, f);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures) {
+        return 1;
+    }
+    printf("frame table: OK (%d frames max)\n", MAX_ANIM_FRAMES);
+    return 0;
+}
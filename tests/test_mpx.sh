@@ -0,0 +1,46 @@
+#!/bin/sh
+# One cat per XI2 master pointer: masters created with xinput spawn cats,
+# removing one makes its cat leave, and the rest keep running.
+. "$(dirname "$0")/xvfb.sh"
+require_xvfb
+if ! command -v xinput >/dev/null 2>&1; then
+    echo "xinput not found, skipping"
+    exit 77
+fi
+
+LOG=$(mktemp)
+trap 'kill $CAT 2>/dev/null; stop_xvfbs; rm -f "$LOG"' EXIT
+
+wait_for() {
+    for _ in $(seq 50); do
+        grep -q "$1" "$LOG" && return 0
+        sleep 0.1
+    done
+    echo "FAIL: no '$1' in log:"
+    cat "$LOG"
+    exit 1
+}
+
+start_xvfb 92 || exit 1
+export DISPLAY=:92
+
+./mousecat >"$LOG" 2>&1 &
+CAT=$!
+wait_for "Cat 1 following pointer"
+
+xinput create-master "cat test one"
+xinput create-master "cat test two"
+wait_for "Cat 3 following pointer"
+
+ID=$(xinput list --id-only "cat test one pointer")
+xinput remove-master "$ID"
+wait_for "Pointer $ID removed, cat leaves"
+
+# Still alive with the remaining two cats
+sleep 0.5
+if ! kill -0 $CAT 2>/dev/null; then
+    echo "FAIL: mousecat exited after the pointer was removed:"
+    cat "$LOG"
+    exit 1
+fi
+echo "mpx: OK"
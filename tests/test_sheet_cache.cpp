@@ -0,0 +1,280 @@
+// Sheet cache entries round-trip their cell shapes, damaged entries are
+// refused, shapes are copied out of the mapping, entries of an older layout
+// are cleaned up, entries owned by another user are not mapped and users
+// sharing a sticky directory publish side by side.
+#include "include/sheet_cache.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const int CELL = 32;
+const uid_t OTHER_UID = 12345;
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+void writeFile(const std::string& path, const void* data, size_t length, mode_t mode) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (fd < 0 || write(fd, data, length) != (ssize_t)length) {
+        printf("Cannot write %s\n", path.c_str());
+        exit(1);
+    }
+    close(fd);
+}
+
+bool exists(const std::string& path) {
+    struct stat st;
+    return lstat(path.c_str(), &st) == 0;
+}
+
+// Each cell gets a differently sized opaque block
+SDL_Surface* makeSheet() {
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, SHEET_COLUMNS * CELL, SHEET_ROWS * CELL, 32,
+                                                        SDL_PIXELFORMAT_RGBA32);
+    for (int y = 0; y < sheet->h; y++) {
+        Uint8* row = (Uint8*)sheet->pixels + y * sheet->pitch;
+        for (int x = 0; x < sheet->w; x++) {
+            int cell = (y / CELL) * SHEET_COLUMNS + x / CELL;
+            bool opaque = x % CELL < 1 + cell % CELL && y % CELL >= cell % 7;
+            row[x * 4] = (Uint8)cell;
+            row[x * 4 + 1] = 0;
+            row[x * 4 + 2] = 0;
+            row[x * 4 + 3] = opaque ? 255 : 0;
+        }
+    }
+    return sheet;
+}
+
+bool sameRects(const std::vector<XRectangle>& a, const std::vector<XRectangle>& b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(XRectangle)) == 0;
+}
+
+bool shapesMatch(const MappedSheet* entry, const SDL_Surface* sheet, const SpriteKernels* kernels) {
+    for (int row = 0; row < SHEET_ROWS; row++) {
+        for (int column = 0; column < SHEET_COLUMNS; column++) {
+            std::vector<XRectangle> want, got;
+            kernels->packShape((const Uint8*)sheet->pixels + row * CELL * sheet->pitch + column * CELL * 4,
+                               sheet->pitch, &want);
+            if (!entry->cellShape(column, row, &got) || !sameRects(want, got)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Anonymous copy of an entry that attach() can own and unmap
+void* copyEntry(const std::vector<Uint8>& bytes) {
+    void* copy = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memcpy(copy, bytes.data(), bytes.size());
+    return copy;
+}
+
+// Another user's session on the same directory: maps root's entry, and can
+// still publish its own next to it. Exit status 0 if both worked.
+int otherUserSession(const std::string& sheetPath, const SDL_Surface* sheet, const SpriteKernels* kernels) {
+    if (setgid(OTHER_UID) != 0 || setuid(OTHER_UID) != 0) {
+        return 2;
+    }
+    SheetCache cache;
+    if (!cache.init()) {
+        return 3;
+    }
+    MappedSheet* opened = cache.open(sheetPath.c_str());
+    MappedSheet* stored = cache.store(sheetPath.c_str(), sheet, kernels);
+    int status = opened && stored ? 0 : 4;
+    delete opened;
+    delete stored;
+    return status;
+}
+
+}  // namespace
+
+int main() {
+    char dirTemplate[] = "/tmp/mousecat-test-XXXXXX";
+    const char* dirName = mkdtemp(dirTemplate);
+    if (!dirName) {
+        printf("Cannot create a temporary directory\n");
+        return 1;
+    }
+    std::string dir = dirName;
+    setenv("XDG_RUNTIME_DIR", dirName, 1);
+    unsetenv(SHEET_CACHE_DIR_ENV);
+
+    std::string sheetPath = dir + "/sheet.png";
+    writeFile(sheetPath, "png", 3, 0644);
+
+    // An entry of an older layout, one named before names had a uid, one
+    // named for another user, a stray file with the same prefix and a temporary
+    char ownPrefix[64];
+    snprintf(ownPrefix, sizeof(ownPrefix), "mousecat-sheet-%u-", (unsigned int)getuid());
+    Uint8 oldHeader[64] = {'M', 'C', 'S', 'H', 'E', 'E', 'T', '\0'};
+    std::string stale = dir + "/" + ownPrefix + "00000000deadbeef";
+    std::string legacy = dir + "/mousecat-sheet-00000000deadbeef";
+    std::string foreign = dir + "/mousecat-sheet-" + std::to_string(getuid() + 1) + "-00000000deadbeef";
+    std::string stray = dir + "/mousecat-sheet-notes";
+    std::string temporary = stale + ".a1b2c3";
+    writeFile(stale, oldHeader, sizeof(oldHeader), 0400);
+    writeFile(legacy, oldHeader, sizeof(oldHeader), 0400);
+    writeFile(foreign, oldHeader, sizeof(oldHeader), 0400);
+    writeFile(stray, "x", 1, 0600);
+    writeFile(temporary, oldHeader, sizeof(oldHeader), 0400);
+
+    SheetCache cache;
+    expect(cache.init(), "init");
+    expect(!exists(stale), "entry of an older layout removed");
+    expect(!exists(legacy), "entry named without a uid removed");
+    expect(exists(foreign) && exists(stray) && exists(temporary), "other files kept");
+
+    SDL_Surface* sheet = makeSheet();
+    const SpriteKernels* kernels = spriteKernelsFor(CELL);
+    MappedSheet* stored = cache.store(sheetPath.c_str(), sheet, kernels);
+    expect(stored && stored->frameSize() == CELL, "store");
+    expect(stored && shapesMatch(stored, sheet, kernels), "stored shapes");
+
+    MappedSheet* opened = cache.open(sheetPath.c_str());
+    expect(opened && shapesMatch(opened, sheet, kernels), "opened shapes");
+    std::vector<XRectangle> rects;
+    expect(opened && !opened->cellShape(SHEET_COLUMNS, 0, &rects) && !opened->cellShape(0, -1, &rects),
+           "cells outside the sheet");
+    delete opened;
+
+    // The current entry survives another session starting
+    SheetCache again;
+    again.init();
+    opened = again.open(sheetPath.c_str());
+    expect(opened != nullptr, "current entry kept");
+    delete opened;
+
+    // Raw bytes of the entry for the damage tests
+    std::string entryPath;
+    DIR* listing = opendir(dirName);
+    while (struct dirent* ent = readdir(listing)) {
+        if (strlen(ent->d_name) == strlen(ownPrefix) + 16 &&
+            strncmp(ent->d_name, ownPrefix, strlen(ownPrefix)) == 0) {
+            entryPath = dir + "/" + ent->d_name;
+        }
+    }
+    closedir(listing);
+    std::vector<Uint8> bytes;
+    FILE* file = fopen(entryPath.c_str(), "rb");
+    if (file) {
+        int c;
+        while ((c = fgetc(file)) != EOF) {
+            bytes.push_back((Uint8)c);
+        }
+        fclose(file);
+    }
+    expect(!bytes.empty(), "entry on disk");
+
+    if (!bytes.empty()) {
+        // Shapes come from the copy taken at attach, not from the mapping
+        MappedSheet copied;
+        void* mapping = copyEntry(bytes);
+        expect(copied.attach(mapping, bytes.size()), "attach copy");
+        memset(mapping, 0xff, bytes.size());
+        expect(shapesMatch(&copied, sheet, kernels), "shapes after the mapping changed");
+
+        MappedSheet truncated;
+        expect(!truncated.attach(copyEntry(bytes), bytes.size() - 1), "truncated entry refused");
+
+        // Last rectangle pushed outside its cell
+        std::vector<Uint8> outside = bytes;
+        XRectangle* last = (XRectangle*)(outside.data() + outside.size()) - 1;
+        last->x = CELL;
+        MappedSheet badRect;
+        expect(!badRect.attach(copyEntry(outside), outside.size()), "rectangle outside its cell refused");
+
+        // Last cell index pointing past the rectangles, as a damaged index would
+        std::vector<Uint8> index = bytes;
+        size_t rectBytes = 0;
+        for (int row = 0; row < SHEET_ROWS; row++) {
+            for (int column = 0; column < SHEET_COLUMNS; column++) {
+                stored->cellShape(column, row, &rects);
+                rectBytes += rects.size() * sizeof(XRectangle);
+            }
+        }
+        Uint32* cellEnd = (Uint32*)(index.data() + index.size() - rectBytes) - 1;
+        while ((Uint8*)cellEnd > index.data() && *cellEnd == 0) {
+            cellEnd--;  // Skip alignment padding
+        }
+        *cellEnd += 1000;
+        MappedSheet badIndex;
+        expect(!badIndex.attach(copyEntry(index), index.size()), "damaged cell index refused");
+    }
+
+    // In a sticky world-writable directory another user maps root's entry and
+    // publishes beside it instead of failing to replace it
+    if (getuid() == 0) {
+        chmod(dirName, 01777);
+        // Republish root's entry world-readable, as a shared directory does
+        setenv(SHEET_CACHE_DIR_ENV, dirName, 1);
+        SheetCache sharedCache;
+        sharedCache.init();
+        delete sharedCache.store(sheetPath.c_str(), sheet, kernels);
+
+        pid_t child = fork();
+        if (child == 0) {
+            _exit(otherUserSession(sheetPath, sheet, kernels));
+        }
+        int status = -1;
+        waitpid(child, &status, 0);
+        expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "another user shares root's entry and publishes its own");
+        char otherPrefix[64];
+        snprintf(otherPrefix, sizeof(otherPrefix), "mousecat-sheet-%u-", (unsigned int)OTHER_UID);
+        int otherEntries = 0;
+        listing = opendir(dirName);
+        while (struct dirent* ent = readdir(listing)) {
+            otherEntries += strlen(ent->d_name) == strlen(otherPrefix) + 16 &&
+                            strncmp(ent->d_name, otherPrefix, strlen(otherPrefix)) == 0;
+        }
+        closedir(listing);
+        expect(otherEntries == 1, "other user's entry under its own name");
+        unsetenv(SHEET_CACHE_DIR_ENV);
+    } else {
+        printf("Not root, skipping the shared directory check\n");
+    }
+
+    // Root can hand entries to another owner, which open() must not map
+    if (getuid() == 0 && !entryPath.empty()) {
+        expect(chown(entryPath.c_str(), OTHER_UID, OTHER_UID) == 0, "chown");
+        opened = cache.open(sheetPath.c_str());
+        expect(opened == nullptr, "entry owned by another user refused");
+        delete opened;
+    } else {
+        printf("Not root, skipping the foreign owner check\n");
+    }
+
+    delete stored;
+    SDL_FreeSurface(sheet);
+
+    listing = opendir(dirName);
+    while (struct dirent* ent = readdir(listing)) {
+        if (ent->d_name[0] != '.') {
+            unlink((dir + "/" + ent->d_name).c_str());
+        }
+    }
+    closedir(listing);
+    rmdir(dirName);
+
+    if (failures) {
+        return 1;
+    }
+    printf("sheet cache: OK\n");
+    return 0;
+}
@@ -0,0 +1,108 @@
+// packShape and blend give the same rectangles and pixels as the per-pixel
+// loops they replaced, for every supported cell size, on sprite-like cells,
+// noise, full and empty cells and alphas on either side of the threshold.
+#include "sprite_reference.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int CELLS = 500;      // Random cells per kind and size
+const int CELL_COLUMN = 3;  // Cells sit inside a sheet-wide row, like the real sheet
+
+int failures = 0;
+
+enum CellKind { SPRITE, NOISE, OPAQUE, EMPTY, THRESHOLD, CELL_KIND_COUNT };
+const char* const KIND_NAMES[] = {"sprite", "noise", "opaque", "empty", "threshold"};
+
+void fillCell(CellKind kind, Uint8* cell, int pitch, int size) {
+    switch (kind) {
+        case SPRITE:
+            spriteCell(cell, pitch, size);
+            break;
+        case NOISE:
+            noiseCell(cell, pitch, size);
+            break;
+        case OPAQUE:
+        case EMPTY:
+            for (int y = 0; y < size; y++) {
+                memset(cell + y * pitch, kind == OPAQUE ? 255 : 0, size * 4);
+            }
+            break;
+        default:
+            // Alpha right at the threshold is transparent, one above is opaque
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    cell[y * pitch + x * 4 + 3] = (Uint8)(SHAPE_ALPHA_THRESHOLD + rand() % 2);
+                }
+            }
+            break;
+    }
+}
+
+bool sameRects(const std::vector<XRectangle>& a, const std::vector<XRectangle>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].width != b[i].width || a[i].height != b[i].height) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    const int sizes[] = {16, 32, 48, 64};
+
+    srand(1);
+    for (int size : sizes) {
+        const SpriteKernels* kernels = spriteKernelsFor(size);
+        if (!kernels) {
+            printf("FAIL no kernels for %d px\n", size);
+            failures++;
+            continue;
+        }
+
+        int pitch = SHEET_COLUMNS * size * 4;
+        std::vector<Uint8> sheet(pitch * size);
+        std::vector<Uint8> canvas(pitch * size), expectedCanvas(pitch * size);
+        Uint8* cell = sheet.data() + CELL_COLUMN * size * 4;
+
+        for (int kind = 0; kind < CELL_KIND_COUNT; kind++) {
+            for (int i = 0; i < CELLS; i++) {
+                fillCell((CellKind)kind, cell, pitch, size);
+
+                std::vector<XRectangle> want, got;
+                referencePackShape(cell, pitch, size, &want);
+                kernels->packShape(cell, pitch, &got);
+                if (!sameRects(want, got)) {
+                    if (failures++ < 10) {
+                        printf("FAIL %d px %s cell %d: packShape gave %d rect(s), expected %d\n",
+                               size, KIND_NAMES[kind], i, (int)got.size(), (int)want.size());
+                    }
+                }
+
+                for (size_t b = 0; b < canvas.size(); b++) {
+                    canvas[b] = expectedCanvas[b] = (Uint8)rand();
+                }
+                referenceBlend(cell, pitch, size, expectedCanvas.data(), pitch);
+                kernels->blend(cell, pitch, canvas.data(), pitch);
+                if (canvas != expectedCanvas) {
+                    if (failures++ < 10) {
+                        printf("FAIL %d px %s cell %d: blend differs\n", size, KIND_NAMES[kind], i);
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures) {
+        printf("%d mismatch(es)\n", failures);
+        return 1;
+    }
+    printf("sprite kernels: OK\n");
+    return 0;
+}
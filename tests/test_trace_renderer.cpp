@@ -0,0 +1,171 @@
+// Trace renders are byte-identical whatever the thread count, and the APNG
+// is well formed: IHDR then acTL, one unbroken fcTL/fdAT sequence, and a
+// first frame that covers the whole canvas.
+#include "include/trace_renderer.h"
+#include <unistd.h>
+#include <zlib.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* SHEET_PATH = "src/sprite/oneko-W.png";
+const int TRACE_MS = 12000;
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+Uint32 getU32(const Uint8* p) {
+    return ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) | ((Uint32)p[2] << 8) | p[3];
+}
+
+// A sweep across the screen, a pause long enough to idle, then a circle
+void writeTrace(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    fprintf(file, "# synthetic trace\n");
+    for (int t = 0; t <= TRACE_MS; t += 8) {
+        int x, y;
+        if (t < 3000) {
+            x = 100 + t / 4;
+            y = 200 + t / 10;
+        } else if (t < 9000) {
+            x = 850;
+            y = 500;
+        } else {
+            double a = (t - 9000) / 500.0;
+            x = 850 + (int)(150 * cos(a));
+            y = 500 + (int)(150 * sin(a));
+        }
+        fprintf(file, "%d %d %d\n", t, x, y);
+    }
+    fclose(file);
+}
+
+std::vector<Uint8> readFile(const std::string& path) {
+    std::vector<Uint8> bytes;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return bytes;
+    }
+    Uint8 buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        bytes.insert(bytes.end(), buf, buf + n);
+    }
+    fclose(file);
+    return bytes;
+}
+
+void checkChunks(const std::vector<Uint8>& png) {
+    static const Uint8 SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if (png.size() < 8 || memcmp(png.data(), SIGNATURE, 8) != 0) {
+        expect(false, "PNG signature");
+        return;
+    }
+
+    std::vector<std::string> order;
+    Uint32 canvasW = 0, canvasH = 0, frameCount = 0, frames = 0;
+    Uint32 nextSequence = 0;
+    bool sequenceOk = true, firstFrameFull = false, regionsOk = true, crcOk = true;
+
+    size_t pos = 8;
+    while (pos + 12 <= png.size()) {
+        Uint32 length = getU32(&png[pos]);
+        if (pos + 12 + length > png.size()) {
+            expect(false, "chunk runs past the end of the file");
+            return;
+        }
+        std::string type((const char*)&png[pos + 4], 4);
+        const Uint8* data = &png[pos + 8];
+        Uint32 crc = (Uint32)crc32(0L, &png[pos + 4], length + 4);
+        crcOk = crcOk && crc == getU32(data + length);
+        order.push_back(type);
+
+        if (type == "IHDR") {
+            canvasW = getU32(data);
+            canvasH = getU32(data + 4);
+        } else if (type == "acTL") {
+            frameCount = getU32(data);
+        } else if (type == "fcTL" || type == "fdAT") {
+            sequenceOk = sequenceOk && getU32(data) == nextSequence++;
+        }
+        if (type == "fcTL") {
+            Uint32 w = getU32(data + 4), h = getU32(data + 8);
+            Uint32 x = getU32(data + 12), y = getU32(data + 16);
+            if (frames == 0) {
+                firstFrameFull = w == canvasW && h == canvasH && x == 0 && y == 0;
+            }
+            regionsOk = regionsOk && w > 0 && h > 0 && x + w <= canvasW && y + h <= canvasH;
+            frames++;
+        }
+        pos += 12 + length;
+    }
+
+    expect(pos == png.size(), "chunks end at the end of the file");
+    expect(crcOk, "chunk CRCs");
+    expect(order.size() >= 4 && order[0] == "IHDR" && order[1] == "acTL", "IHDR and acTL come first");
+    expect(order.size() >= 3 && order[2] == "fcTL", "first frame control follows acTL");
+    expect(!order.empty() && order.back() == "IEND", "IEND comes last");
+    expect(sequenceOk, "fcTL/fdAT sequence numbers are continuous from 0");
+    expect(frames > 1 && frames == frameCount, "acTL counts every fcTL");
+    expect(firstFrameFull, "first frame covers the full canvas");
+    expect(regionsOk, "frame regions lie inside the canvas");
+}
+
+}  // namespace
+
+int main() {
+    if (access(SHEET_PATH, R_OK) != 0) {
+        printf("SKIP %s not found, run from the source tree\n", SHEET_PATH);
+        return 77;
+    }
+
+    char dirTemplate[] = "/tmp/mousecat-trace-XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        printf("Cannot create a temporary directory\n");
+        return 1;
+    }
+    std::string dir = dirTemplate;
+    std::string tracePath = dir + "/trace.txt";
+    std::string onePath = dir + "/one.png";
+    std::string fourPath = dir + "/four.png";
+    writeTrace(tracePath);
+
+    bool rendered = true;
+    {
+        TraceRenderer renderer;
+        rendered = renderer.render(tracePath.c_str(), SHEET_PATH, onePath.c_str(), 1, RENDER_SEED) && rendered;
+    }
+    {
+        TraceRenderer renderer;
+        rendered = renderer.render(tracePath.c_str(), SHEET_PATH, fourPath.c_str(), 4, RENDER_SEED) && rendered;
+    }
+    expect(rendered, "render");
+
+    std::vector<Uint8> one = readFile(onePath);
+    std::vector<Uint8> four = readFile(fourPath);
+    expect(!one.empty() && one == four, "1 and 4 threads write the same bytes");
+    checkChunks(one);
+
+    unlink(tracePath.c_str());
+    unlink(onePath.c_str());
+    unlink(fourPath.c_str());
+    rmdir(dir.c_str());
+
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("trace renderer: OK\n");
+    return 0;
+}
@@ -0,0 +1,121 @@
+// WindowIndex answers the same as a linear scan, across cell sizes and
+// after windows move, restack, unmap and go away.
+#include "window_scan.h"
+#include <cstdio>
+
+namespace {
+
+const int DESKTOP_W = 3840;
+const int DESKTOP_H = 2160;
+const int WINDOWS = 500;
+const int QUERIES = 20000;
+
+int failures = 0;
+
+void compare(const WindowIndex& index, const WindowScan& scan, int cellSize, const char* stage) {
+    for (int i = 0; i < QUERIES; i++) {
+        double x0 = rand() % DESKTOP_W;
+        double y0 = rand() % DESKTOP_H;
+        double x1 = x0 + rand() % 401 - 200;
+        double y1 = y0 + rand() % 401 - 200;
+        double goalX = rand() % DESKTOP_W;
+        double goalY = rand() % DESKTOP_H;
+
+        if (index.segmentIntersects(x0, y0, x1, y1, goalX, goalY) !=
+            scan.segmentIntersects(x0, y0, x1, y1, goalX, goalY)) {
+            if (failures++ < 10) {
+                printf("FAIL %s cell %d: segment (%g,%g)-(%g,%g)\n", stage, cellSize, x0, y0, x1, y1);
+            }
+        }
+
+        double perchX, perchY;
+        Window w;
+        double expected = scan.nearestPerch(x0, y0, 32.0);
+        bool found = index.nearestPerch(x0, y0, 32.0, &perchX, &perchY, &w);
+        double got = found ? (perchX - x0) * (perchX - x0) + (perchY - y0) * (perchY - y0) : -1;
+        if (got != expected) {
+            if (failures++ < 10) {
+                printf("FAIL %s cell %d: perch near (%g,%g): %g, expected %g\n",
+                       stage, cellSize, x0, y0, got, expected);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    const int cellSizes[] = {64, 256, 1024};
+
+    for (int cellSize : cellSizes) {
+        srand(cellSize);
+        WindowIndex index(cellSize);
+        WindowScan scan;
+        for (int i = 0; i < WINDOWS; i++) {
+            WindowRect r = randomWindow(DESKTOP_W, DESKTOP_H);
+            index.setWindow(i + 1, r, true);
+            scan.add(i + 1, r);
+        }
+        compare(index, scan, cellSize, "fill");
+
+        // Raise every fifth window and lower every thirteenth
+        for (int i = 0; i < WINDOWS; i += 5) {
+            index.restackWindow(scan.ids[i], scan.ids.back());
+            scan.restack(i, true);
+        }
+        for (int i = 0; i < WINDOWS; i += 13) {
+            index.restackWindow(scan.ids[i], None);
+            scan.restack(i, false);
+        }
+        compare(index, scan, cellSize, "restack");
+
+        // Move every other window, unmap a few and destroy a few more
+        WindowScan changed;
+        for (int i = 0; i < WINDOWS; i++) {
+            Window w = scan.ids[i];
+            WindowRect r = scan.rects[i];
+            if (i % 2 == 0) {
+                r.x += rand() % 101 - 50;
+                r.y += rand() % 101 - 50;
+                index.setWindow(w, r, true);
+            }
+            if (i % 7 == 0) {
+                index.setWindow(w, r, false);
+                continue;
+            }
+            if (i % 11 == 0) {
+                index.removeWindow(w);
+                continue;
+            }
+            changed.add(w, r);
+        }
+        compare(index, changed, cellSize, "update");
+    }
+
+    // A window under a bigger one: no perch on its edge, no dodging it
+    WindowIndex index(256);
+    WindowRect small = {400, 400, 200, 100};
+    WindowRect big = {300, 300, 500, 400};
+    index.setWindow(1, small, true);
+    index.setWindow(2, big, true);
+    double perchX, perchY;
+    Window w;
+    if (index.nearestPerch(500, 390, 32.0, &perchX, &perchY, &w) ||
+        index.segmentIntersects(350, 450, 700, 450, 900, 900)) {
+        printf("FAIL window stacked under another is still in the way\n");
+        failures++;
+    }
+    index.restackWindow(1, 2);
+    if (!index.nearestPerch(500, 390, 32.0, &perchX, &perchY, &w) || w != 1 ||
+        !index.segmentIntersects(350, 450, 700, 450, 900, 900)) {
+        printf("FAIL raised window is ignored\n");
+        failures++;
+    }
+
+    if (failures) {
+        printf("%d mismatch(es)\n", failures);
+        return 1;
+    }
+    printf("window index: OK\n");
+    return 0;
+}
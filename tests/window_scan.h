@@ -0,0 +1,109 @@
+#ifndef WINDOW_SCAN_H
+#define WINDOW_SCAN_H
+
+#include "include/window_index.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+// Reference for WindowIndex: the linear scan over every window it replaced.
+// Windows are kept bottom to top. Shared by the window index test and benchmark.
+struct WindowScan {
+    std::vector<Window> ids;
+    std::vector<WindowRect> rects;
+
+    void add(Window w, const WindowRect& r) {
+        ids.push_back(w);
+        rects.push_back(r);
+    }
+
+    // Move the i-th window from the bottom to the top or the bottom
+    void restack(size_t i, bool top) {
+        Window w = ids[i];
+        WindowRect r = rects[i];
+        ids.erase(ids.begin() + i);
+        rects.erase(rects.begin() + i);
+        ids.insert(top ? ids.end() : ids.begin(), w);
+        rects.insert(top ? rects.end() : rects.begin(), r);
+    }
+
+    static bool contains(const WindowRect& r, double px, double py) {
+        return px >= r.x && px < r.x + r.w && py >= r.y && py < r.y + r.h;
+    }
+
+    // Same Liang-Barsky clip as window_index.cpp
+    static bool crosses(const WindowRect& r, double x0, double y0, double x1, double y1) {
+        double dx = x1 - x0;
+        double dy = y1 - y0;
+        double p[4] = {-dx, dx, -dy, dy};
+        double q[4] = {x0 - r.x, r.x + r.w - x0, y0 - r.y, r.y + r.h - y0};
+        double t0 = 0.0;
+        double t1 = 1.0;
+        for (int i = 0; i < 4; i++) {
+            if (p[i] == 0.0) {
+                if (q[i] < 0.0) return false;
+                continue;
+            }
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                if (t > t1) return false;
+                if (t > t0) t0 = t;
+            } else {
+                if (t < t0) return false;
+                if (t < t1) t1 = t;
+            }
+        }
+        return true;
+    }
+
+    bool coveredAt(size_t i, double px, double py) const {
+        for (size_t j = i + 1; j < rects.size(); j++) {
+            if (contains(rects[j], px, py)) return true;
+        }
+        return false;
+    }
+
+    bool hidden(size_t i) const {
+        const WindowRect& r = rects[i];
+        for (size_t j = i + 1; j < rects.size(); j++) {
+            const WindowRect& o = rects[j];
+            if (r.x >= o.x && r.y >= o.y && r.x + r.w <= o.x + o.w && r.y + r.h <= o.y + o.h) return true;
+        }
+        return false;
+    }
+
+    bool segmentIntersects(double x0, double y0, double x1, double y1, double goalX, double goalY) const {
+        for (size_t i = 0; i < rects.size(); i++) {
+            const WindowRect& r = rects[i];
+            if (contains(r, x0, y0) || contains(r, goalX, goalY)) continue;
+            if (crosses(r, x0, y0, x1, y1) && !hidden(i)) return true;
+        }
+        return false;
+    }
+
+    // Distance to the nearest uncovered top edge within maxDistance, -1 if none
+    double nearestPerch(double px, double py, double maxDistance) const {
+        double best2 = -1;
+        for (size_t i = 0; i < rects.size(); i++) {
+            const WindowRect& r = rects[i];
+            double ex = std::min(std::max(px, (double)r.x), (double)(r.x + r.w - 1));
+            double d2 = (ex - px) * (ex - px) + (r.y - py) * (r.y - py);
+            if (d2 <= maxDistance * maxDistance && (best2 < 0 || d2 < best2) && !coveredAt(i, ex, r.y)) {
+                best2 = d2;
+            }
+        }
+        return best2;
+    }
+};
+
+// Desktop-like random windows: title-bar sized and up, all indexable
+inline WindowRect randomWindow(int desktopW, int desktopH) {
+    WindowRect r;
+    r.w = WINDOW_MIN_WIDTH + rand() % 640;
+    r.h = WINDOW_MIN_HEIGHT + rand() % 480;
+    r.x = rand() % desktopW - r.w / 2;
+    r.y = rand() % desktopH - r.h / 2;
+    return r;
+}
+
+#endif // WINDOW_SCAN_H
@@ -0,0 +1,34 @@
+# Sourced by the X scripts: start_xvfb NUM starts Xvfb on :NUM, waits for
+# its socket and records its pid; stop_xvfbs kills every server started.
+# Scripts exit 77 (skipped) when Xvfb is missing.
+
+XVFB_PIDS=""
+
+require_xvfb() {
+    if ! command -v Xvfb >/dev/null 2>&1; then
+        echo "Xvfb not found, skipping"
+        exit 77
+    fi
+}
+
+start_xvfb() {
+    Xvfb ":$1" -screen 0 1920x1080x24 -nolisten tcp >/dev/null 2>&1 &
+    XVFB_PID=$!
+    XVFB_PIDS="$XVFB_PIDS $XVFB_PID"
+    for _ in $(seq 50); do
+        [ -S "/tmp/.X11-unix/X$1" ] && return 0
+        sleep 0.1
+    done
+    echo "Xvfb :$1 did not start"
+    return 1
+}
+
+stop_xvfbs() {
+    [ -n "$XVFB_PIDS" ] && kill $XVFB_PIDS 2>/dev/null
+    wait 2>/dev/null
+}
+
+# utime + stime of a process, in clock ticks
+cpu_ticks() {
+    awk '{ print $14 + $15 }' "/proc/$1/stat"
+}